@@ -0,0 +1,294 @@
+#include "AllocationGuard.h"
+
+#if SPECTROGRAM_CHECK_ALLOCATIONS
+
+static thread_local int guardDepth = 0;
+static thread_local bool isReportingAllocation = false;
+static thread_local juce::int64 numAllocations = 0;
+
+static void countAllocation() {
+    numAllocations++;
+
+    // The assertion machinery can allocate too, so don't let it trip itself.
+    if (guardDepth > 0 && !isReportingAllocation) {
+        isReportingAllocation = true;
+        jassertfalse; // Something on the analysis hot path just allocated.
+        isReportingAllocation = false;
+    }
+}
+
+#if JUCE_LINUX
+
+#include <dlfcn.h>
+
+// juce::HeapBlock, AudioBuffer and anything C allocate with malloc directly, so on Linux the malloc family is
+// interposed as well (the executable's definitions win over libc's), and operator new is counted there.
+using MallocFunction = void* (*)(std::size_t);
+using CallocFunction = void* (*)(std::size_t, std::size_t);
+using ReallocFunction = void* (*)(void*, std::size_t);
+using FreeFunction = void (*)(void*);
+using PosixMemalignFunction = int (*)(void**, std::size_t, std::size_t);
+using AlignedAllocFunction = void* (*)(std::size_t, std::size_t);
+
+static std::atomic<MallocFunction> nextMalloc { nullptr };
+static std::atomic<CallocFunction> nextCalloc { nullptr };
+static std::atomic<ReallocFunction> nextRealloc { nullptr };
+static std::atomic<FreeFunction> nextFree { nullptr };
+static std::atomic<PosixMemalignFunction> nextPosixMemalign { nullptr };
+static std::atomic<AlignedAllocFunction> nextAlignedAlloc { nullptr };
+
+// dlsym can allocate while it looks the real functions up, so whatever it asks for comes from here instead.
+// It's only ever a handful of small blocks, which are never reused.
+alignas(std::max_align_t) static char resolvingArena[8192];
+static std::atomic<std::size_t> resolvingArenaUsed { 0 };
+static thread_local int resolvingDepth = 0;
+
+static bool isFromResolvingArena(void* pointer) {
+    return pointer >= resolvingArena && pointer < resolvingArena + sizeof(resolvingArena);
+}
+
+static void* allocateWhileResolving(std::size_t size) {
+    auto alignedSize = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    auto offset = resolvingArenaUsed.fetch_add(alignedSize);
+    return offset + alignedSize <= sizeof(resolvingArena) ? resolvingArena + offset : nullptr;
+}
+
+// Resolved on first use, as in the stress host's LockCounter.
+template <typename Function>
+static Function findNext(std::atomic<Function>& next, const char* name) {
+    auto function = next.load(std::memory_order_acquire);
+
+    if (function == nullptr) {
+        resolvingDepth++;
+        function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+        resolvingDepth--;
+        next.store(function, std::memory_order_release);
+    }
+
+    return function;
+}
+
+extern "C" void* malloc(std::size_t size) {
+    if (resolvingDepth > 0) {
+        return allocateWhileResolving(size);
+    }
+
+    countAllocation();
+    return findNext(nextMalloc, "malloc")(size);
+}
+
+extern "C" void* calloc(std::size_t count, std::size_t size) {
+    // The arena is zeroed to start with, and never reused.
+    if (resolvingDepth > 0) {
+        return allocateWhileResolving(count * size);
+    }
+
+    countAllocation();
+    return findNext(nextCalloc, "calloc")(count, size);
+}
+
+extern "C" void* realloc(void* pointer, std::size_t size) {
+    if (isFromResolvingArena(pointer) || (resolvingDepth > 0 && pointer == nullptr)) {
+        // The old size isn't kept, but copying past it only reads more of the arena.
+        void* moved = malloc(size);
+
+        if (moved != nullptr && pointer != nullptr) {
+            std::memcpy(moved, pointer, juce::jmin(size, (std::size_t)(resolvingArena + sizeof(resolvingArena) - static_cast<char*>(pointer))));
+        }
+
+        return moved;
+    }
+
+    countAllocation();
+    return findNext(nextRealloc, "realloc")(pointer, size);
+}
+
+extern "C" void free(void* pointer) {
+    if (isFromResolvingArena(pointer)) {
+        return;
+    }
+
+    findNext(nextFree, "free")(pointer);
+}
+
+extern "C" int posix_memalign(void** pointer, std::size_t alignment, std::size_t size) {
+    countAllocation();
+    return findNext(nextPosixMemalign, "posix_memalign")(pointer, alignment, size);
+}
+
+extern "C" void* aligned_alloc(std::size_t alignment, std::size_t size) {
+    countAllocation();
+    return findNext(nextAlignedAlloc, "aligned_alloc")(alignment, size);
+}
+
+#endif
+
+static void* checkedAllocate(std::size_t size) {
+   #if ! JUCE_LINUX
+    countAllocation();
+   #endif
+
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+static void* checkedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+   #if ! JUCE_LINUX
+    countAllocation();
+   #endif
+
+    auto bytes = size == 0 ? 1 : size;
+
+   #if JUCE_WINDOWS
+    if (void* pointer = _aligned_malloc(bytes, (std::size_t)alignment)) {
+        return pointer;
+    }
+   #else
+    void* pointer = nullptr;
+
+    if (posix_memalign(&pointer, juce::jmax((std::size_t)alignment, sizeof(void*)), bytes) == 0) {
+        return pointer;
+    }
+   #endif
+
+    throw std::bad_alloc();
+}
+
+static void freeAligned(void* pointer) {
+   #if JUCE_WINDOWS
+    _aligned_free(pointer);
+   #else
+    std::free(pointer);
+   #endif
+}
+
+void* operator new(std::size_t size) {
+    return checkedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return checkedAllocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return checkedAllocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return checkedAllocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return checkedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return checkedAllocateAligned(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return checkedAllocateAligned(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return checkedAllocateAligned(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    freeAligned(pointer);
+}
+
+AllocationGuard::AllocationGuard() {
+    guardDepth++;
+}
+
+AllocationGuard::~AllocationGuard() {
+    guardDepth--;
+}
+
+bool AllocationGuard::isEnabled() {
+    return true;
+}
+
+juce::int64 AllocationGuard::getNumAllocationsOnThisThread() {
+    return numAllocations;
+}
+
+#else
+
+AllocationGuard::AllocationGuard() {}
+
+AllocationGuard::~AllocationGuard() {}
+
+bool AllocationGuard::isEnabled() {
+    return false;
+}
+
+juce::int64 AllocationGuard::getNumAllocationsOnThisThread() {
+    return 0;
+}
+
+#endif
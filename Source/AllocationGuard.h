@@ -0,0 +1,26 @@
+#pragma once
+#include <JuceHeader.h>
+
+// When enabled, every global operator new/delete is replaced (and on Linux, malloc and friends are interposed) so
+// that allocations can be counted per thread, and so that allocating inside an AllocationGuard scope asserts.
+// That's process-wide, so it's off by default: inside a plugin it would catch the host's and every other plugin's
+// allocations too. The benchmark and stress host turn it on in their .jucer files.
+#ifndef SPECTROGRAM_CHECK_ALLOCATIONS
+ #define SPECTROGRAM_CHECK_ALLOCATIONS 0
+#endif
+
+// Marks a scope on the analysis hot path that must never touch the allocator.
+// Compiles to nothing unless SPECTROGRAM_CHECK_ALLOCATIONS is enabled.
+class AllocationGuard
+{
+public:
+    AllocationGuard();
+    ~AllocationGuard();
+
+    static bool isEnabled();
+
+    // Number of allocations the calling thread has made so far, or 0 if checking is disabled.
+    static juce::int64 getNumAllocationsOnThisThread();
+
+    JUCE_DECLARE_NON_COPYABLE(AllocationGuard)
+};
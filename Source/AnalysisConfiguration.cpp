@@ -0,0 +1,167 @@
+#include "AnalysisConfiguration.h"
+
+// Gives the Kaiser window side lobes about as low as Blackman-Harris's (-92 dB).
+static constexpr double kaiserBeta = 9.0;
+
+// The Gaussian is cut off at 4 standard deviations either side, about -70 dB.
+static constexpr double gaussianWidthInDeviations = 8.0;
+
+// The windows are scaled to Blackman-Harris's coherent gain, so levels don't move when switching.
+static constexpr double blackmanHarrisCoherentGain = 0.35875;
+
+// Sum of a[k] * (-1)^k * cos(k * theta) and its derivative with respect to theta.
+static void cosineSum(const std::vector<double>& a, double theta, double& value, double& derivative) {
+    value = 0;
+    derivative = 0;
+
+    for (size_t k = 0; k < a.size(); k++) {
+        double sign = (k & 1) ? -1.0 : 1.0;
+        value += sign * a[k] * std::cos((double)k * theta);
+        derivative -= sign * a[k] * (double)k * std::sin((double)k * theta);
+    }
+}
+
+// The power of two nearest to how much bigger a is than b. Being a power of two, scaling by it and back is exact.
+static float getPackingGain(const std::vector<float>& a, const std::vector<float>& b) {
+    auto sumOfMagnitudes = [](const std::vector<float>& window) {
+        return std::accumulate(window.begin(), window.end(), 0.0, [](double sum, float value) { return sum + std::abs(value); });
+    };
+
+    double sumA = sumOfMagnitudes(a);
+    double sumB = sumOfMagnitudes(b);
+    return sumA > 0 && sumB > 0 ? (float)std::exp2(std::round(std::log2(sumA / sumB))) : 1.f;
+}
+
+// I0(x), and I1(x) / x which stays finite at x = 0, from their power series.
+static void besselI0AndI1OverX(double x, double& i0, double& i1OverX) {
+    double quarterSquare = x * x * 0.25;
+    double term = 1.0;
+    i0 = 1.0;
+    i1OverX = 0.5;
+
+    for (int k = 1; k < 64 && term > 1.0e-17 * i0; k++) {
+        term *= quarterSquare / ((double)k * (double)k);
+        i0 += term;
+        i1OverX += term * 0.5 / (double)(k + 1);
+    }
+}
+
+juce::StringArray AnalysisConfiguration::getWindowNames() {
+    return { "Blackman-Harris", "Hann", "Gaussian", "Kaiser" };
+}
+
+std::vector<double> AnalysisConfiguration::getCosineSumTerms(Window window) {
+    switch (window) {
+        case Window::blackmanHarris: return { 0.35875, 0.48829, 0.14128, 0.01168 };
+        case Window::hann: return { 0.5, 0.5 };
+        case Window::gaussian:
+        case Window::kaiser: break;
+    }
+
+    return {};
+}
+
+AnalysisConfiguration::AnalysisConfiguration(int _fftOrder, Window _window):
+    fftOrder(_fftOrder),
+    fftSize(1 << _fftOrder),
+    window(_window),
+    standardWindow(1 << _fftOrder, 0.0f),
+    derivativeWindow(1 << _fftOrder, 0.0f),
+    timeWeightedWindow(1 << _fftOrder, 0.0f),
+    derivativeTimeWeightedWindow(1 << _fftOrder, 0.0f),
+    derivativeWindowGain(1.f),
+    derivativeTimeWeightedWindowGain(1.f)
+{
+    // Symmetric windows, with time in samples from the centre and the derivative per sample.
+    double centre = (fftSize - 1) * 0.5;
+    std::vector<double> values((size_t)fftSize), derivatives((size_t)fftSize);
+    auto cosineTerms = getCosineSumTerms(window);
+
+    for (int i = 0; i < fftSize; i++) {
+        double time = i - centre;
+        double value = 0, derivative = 0;
+
+        switch (window) {
+            case Window::blackmanHarris:
+            case Window::hann: {
+                double theta = juce::MathConstants<double>::twoPi * i / (fftSize - 1);
+                double thetaPerSample = juce::MathConstants<double>::twoPi / (fftSize - 1);
+                cosineSum(cosineTerms, theta, value, derivative);
+                derivative *= thetaPerSample;
+                break;
+            }
+
+            case Window::gaussian: {
+                double deviation = (fftSize - 1) / gaussianWidthInDeviations;
+                value = std::exp(-0.5 * (time / deviation) * (time / deviation));
+                derivative = -time / (deviation * deviation) * value;
+                break;
+            }
+
+            case Window::kaiser: {
+                double u = time / centre;
+                double i0, i1OverX, i0OfBeta, unused;
+                besselI0AndI1OverX(kaiserBeta * std::sqrt(juce::jmax(0.0, 1.0 - u * u)), i0, i1OverX);
+                besselI0AndI1OverX(kaiserBeta, i0OfBeta, unused);
+
+                // d/dt I0(beta * sqrt(1 - u^2)) = -I1(x) / x * beta^2 * u / centre
+                value = i0 / i0OfBeta;
+                derivative = -i1OverX * kaiserBeta * kaiserBeta * u / centre / i0OfBeta;
+                break;
+            }
+        }
+
+        values[(size_t)i] = value;
+        derivatives[(size_t)i] = derivative;
+    }
+
+    double sum = std::accumulate(values.begin(), values.end(), 0.0);
+    double scale = window == Window::blackmanHarris ? 1.0 : blackmanHarrisCoherentGain * fftSize / sum;
+
+    for (int i = 0; i < fftSize; i++) {
+        double time = i - centre;
+        standardWindow[(size_t)i] = (float)(values[(size_t)i] * scale);
+        derivativeWindow[(size_t)i] = (float)(derivatives[(size_t)i] * scale);
+        timeWeightedWindow[(size_t)i] = (float)(values[(size_t)i] * scale * time);
+        derivativeTimeWeightedWindow[(size_t)i] = (float)(derivatives[(size_t)i] * scale * time);
+    }
+
+    derivativeWindowGain = getPackingGain(standardWindow, derivativeWindow);
+    derivativeTimeWeightedWindowGain = getPackingGain(timeWeightedWindow, derivativeTimeWeightedWindow);
+}
+
+//==============================================================================
+AnalysisConfigurationCache::AnalysisConfigurationCache():
+    juce::Thread("Analysis configuration builder")
+{
+    for (auto& configuration : builtConfigurations) {
+        configuration = nullptr;
+    }
+
+    startThread(juce::Thread::Priority::background);
+}
+
+AnalysisConfigurationCache::~AnalysisConfigurationCache() {
+    stopThread(5000);
+}
+
+const AnalysisConfiguration* AnalysisConfigurationCache::get(int fftOrder, AnalysisConfiguration::Window window) const {
+    if (fftOrder < minFFTOrder || fftOrder > maxFFTOrder || (int)window < 0 || (int)window >= AnalysisConfiguration::numWindows) {
+        jassertfalse;
+        return nullptr;
+    }
+
+    return builtConfigurations[(size_t)((int)window * numFFTOrders + fftOrder - minFFTOrder)].load(std::memory_order_acquire);
+}
+
+bool AnalysisConfigurationCache::waitUntilBuilt(int timeoutMs) {
+    return waitForThreadToExit(timeoutMs);
+}
+
+void AnalysisConfigurationCache::run() {
+    for (int index = 0; index < numConfigurations && !threadShouldExit(); index++) {
+        auto window = (AnalysisConfiguration::Window)(index / numFFTOrders);
+        configurations[(size_t)index] = std::make_unique<AnalysisConfiguration>(minFFTOrder + index % numFFTOrders, window);
+        builtConfigurations[(size_t)index].store(configurations[(size_t)index].get(), std::memory_order_release);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <JuceHeader.h>
+
+// The four window tables for one FFT size and window. It is built once and only ever read afterwards, so any
+// number of analysers can share it without locking. The FFT plans aren't shared, each FFTDataGenerator and
+// SlidingDFT has its own: juce::dsp::FFT isn't safe to run from several threads at once (the fallback engine
+// locks, others share a work buffer).
+// The tables come from each window's closed form, so the derivative is exact rather than a finite difference,
+// and the time ramp is in samples from the centre, which is what the reassignment maths expects.
+class AnalysisConfiguration
+{
+public:
+    // Stored in recordings as RecordingFormat::Window, so only ever add to the end.
+    enum class Window { blackmanHarris = 0, hann, gaussian, kaiser };
+    static constexpr int numWindows = 4;
+
+    static juce::StringArray getWindowNames();
+
+    // The a[k] of windows that are a sum of a[k] * (-1)^k * cos(2 pi k n / length), and empty for the others.
+    // Those are the ones a SlidingDFT can apply in the frequency domain.
+    static std::vector<double> getCosineSumTerms(Window window);
+
+    const int fftOrder;
+    const int fftSize;
+    const Window window;
+
+    std::vector<float> standardWindow;
+    std::vector<float> derivativeWindow;
+    std::vector<float> timeWeightedWindow;
+    std::vector<float> derivativeTimeWeightedWindow;
+
+    // Powers of two that bring each derivative window up to about the size of the window it's packed with in
+    // FFTDataGenerator::doFFT. Unscaled, the derivative half is hundreds of times smaller and loses most of its
+    // precision to the other half's rounding.
+    float derivativeWindowGain;
+    float derivativeTimeWeightedWindowGain;
+
+    AnalysisConfiguration(int _fftOrder, Window _window = Window::blackmanHarris);
+
+private:
+    JUCE_DECLARE_NON_COPYABLE(AnalysisConfiguration)
+};
+
+// Builds the configuration for every supported FFT size and window on a background thread, Blackman-Harris first.
+// Until one has been built get() returns nullptr for it, after that the pointer never changes.
+class AnalysisConfigurationCache : private juce::Thread
+{
+public:
+    static constexpr int minFFTOrder = 10;
+    static constexpr int maxFFTOrder = 13;
+    static constexpr int numFFTOrders = maxFFTOrder - minFFTOrder + 1;
+
+    AnalysisConfigurationCache();
+    ~AnalysisConfigurationCache() override;
+
+    const AnalysisConfiguration* get(int fftOrder, AnalysisConfiguration::Window window = AnalysisConfiguration::Window::blackmanHarris) const;
+
+    // For offline use, where there's no point starting before everything is ready.
+    bool waitUntilBuilt(int timeoutMs);
+
+private:
+    static constexpr int numConfigurations = numFFTOrders * AnalysisConfiguration::numWindows;
+
+    // Indexed by window * numFFTOrders + fftOrder - minFFTOrder.
+    std::array<std::unique_ptr<AnalysisConfiguration>, numConfigurations> configurations;
+    std::array<std::atomic<const AnalysisConfiguration*>, numConfigurations> builtConfigurations;
+
+    void run() override;
+
+    JUCE_DECLARE_NON_COPYABLE(AnalysisConfigurationCache)
+};
@@ -0,0 +1,57 @@
+#include "AnalysisRingBuffer.h"
+
+AnalysisRingBuffer::AnalysisRingBuffer(int _numChannels, int _capacity):
+    buffer(_numChannels, _capacity),
+    capacity(_capacity),
+    writePosition(0)
+{
+    buffer.clear();
+}
+
+void AnalysisRingBuffer::push(const juce::AudioBuffer<float>& source, int firstSourceChannel, int startSample, int numSamples) {
+    // Anything older than the capacity would be overwritten anyway.
+    if (numSamples > capacity) {
+        startSample += numSamples - capacity;
+        numSamples = capacity;
+    }
+
+    int firstPart = juce::jmin(numSamples, capacity - writePosition);
+    int secondPart = numSamples - firstPart;
+    int numChannels = juce::jmin(buffer.getNumChannels(), source.getNumChannels() - firstSourceChannel);
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        buffer.copyFrom(channel, writePosition, source, firstSourceChannel + channel, startSample, firstPart);
+
+        if (secondPart > 0) {
+            buffer.copyFrom(channel, 0, source, firstSourceChannel + channel, startSample + firstPart, secondPart);
+        }
+    }
+
+    writePosition = (writePosition + numSamples) % capacity;
+}
+
+void AnalysisRingBuffer::copyLatest(juce::AudioBuffer<float>& destination, int numSamples) const {
+    jassert(numSamples <= capacity && numSamples <= destination.getNumSamples());
+
+    int readPosition = (writePosition - numSamples + capacity) % capacity;
+    int firstPart = juce::jmin(numSamples, capacity - readPosition);
+    int secondPart = numSamples - firstPart;
+    int numChannels = juce::jmin(buffer.getNumChannels(), destination.getNumChannels());
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        destination.copyFrom(channel, 0, buffer, channel, readPosition, firstPart);
+
+        if (secondPart > 0) {
+            destination.copyFrom(channel, firstPart, buffer, channel, 0, secondPart);
+        }
+    }
+}
+
+void AnalysisRingBuffer::clear() {
+    buffer.clear();
+    writePosition = 0;
+}
+
+int AnalysisRingBuffer::getCapacity() const {
+    return capacity;
+}
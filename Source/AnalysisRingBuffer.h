@@ -0,0 +1,25 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Fixed-size circular history of the most recent input samples.
+// Pushing costs only as much as the new samples, regardless of how long the history is.
+class AnalysisRingBuffer
+{
+public:
+    AnalysisRingBuffer(int _numChannels, int _capacity);
+
+    // Copies the source's channels from firstSourceChannel onwards, one per channel of the ring.
+    void push(const juce::AudioBuffer<float>& source, int firstSourceChannel, int startSample, int numSamples);
+
+    // Copies the most recent numSamples samples, oldest first, to the start of destination.
+    void copyLatest(juce::AudioBuffer<float>& destination, int numSamples) const;
+
+    void clear();
+
+    int getCapacity() const;
+
+private:
+    juce::AudioBuffer<float> buffer;
+    int capacity;
+    int writePosition;
+};
@@ -0,0 +1,286 @@
+#include "AnalysisWorker.h"
+
+static_assert(AnalysisWorker::maxStreams <= SpectralRecorder::maxStreams, "Every stream must be recordable");
+
+AnalysisWorker::StreamJob::StreamJob(AnalysisWorker& _worker, int _stream):
+    juce::ThreadPoolJob("Spectral analysis stream"),
+    worker(_worker),
+    stream(_stream)
+{
+}
+
+juce::ThreadPoolJob::JobStatus AnalysisWorker::StreamJob::runJob() {
+    worker.analyseStream(stream);
+    return jobHasFinished;
+}
+
+AnalysisWorker::AnalysisWorker(const AnalysisConfigurationCache& _configurations, SpectralRecorder& _recorder):
+    juce::Thread("Spectral analysis"),
+    configurations(_configurations),
+    recorder(_recorder),
+    chunkBuffer(2, chunkSize),
+    midSideBuffer(2, chunkSize),
+    streamBuffer(&chunkBuffer),
+    sampleRate(48000),
+    numChannels(2),
+    maxBacklogSamples(4800),
+    numOverflowedSamplesSkipped(0),
+    samplePosition(0),
+    currentPriority(juce::Thread::Priority::normal),
+    currentChannelMode(ChannelMode::perChannel),
+    chunkNumSamples(0),
+    chunkCoalesced(false),
+    numStreams(2),
+    activeChannelMode(ChannelMode::perChannel),
+    fftOrder(11),
+    multiResolution(false),
+    window(AnalysisConfiguration::Window::blackmanHarris),
+    hopSize(512),
+    despecklingCutoff(1.f),
+    noiseFloorDb(-100.f),
+    backlogPolicy(BacklogPolicy::coalesce),
+    priority(juce::Thread::Priority::normal),
+    channelMode(ChannelMode::perChannel),
+    displayScale(FrequencyAxis::Scale::log),
+    displayMinFrequency(20.f),
+    displayMaxFrequency(24000.f),
+    displayNumRows(0),
+    trackPartials(false),
+    // The worker thread analyses one stream itself, so there's no point in more threads than the rest.
+    pool(juce::jlimit(1, maxStreams - 1, juce::SystemStats::getNumCpus() - 1))
+{
+    for (int stream = 0; stream < maxStreams; stream++) {
+        jobs.add(new StreamJob(*this, stream));
+    }
+
+    for (int stream = 0; stream < numStreams.load(); stream++) {
+        frameQueues[stream] = std::make_unique<SpectralFrameQueue>(frameQueueCapacity);
+    }
+}
+
+AnalysisWorker::~AnalysisWorker() {
+    stopThread(2000);
+}
+
+void AnalysisWorker::prepare(double _sampleRate, int maximumBlockSize, int _numChannels) {
+    stopThread(2000);
+
+    sampleRate = _sampleRate;
+    numChannels = juce::jlimit(1, maxChannels, _numChannels);
+    chunkBuffer.setSize(numChannels, chunkSize);
+
+    // Enough room for the backlog we tolerate, plus a few host blocks on top.
+    maxBacklogSamples = (int)(sampleRate * maxBacklogSeconds);
+    sampleQueue.prepare(numChannels, maxBacklogSamples + 4 * juce::jmax(maximumBlockSize, chunkSize));
+    numOverflowedSamplesSkipped = 0;
+    samplePosition = 0;
+
+    // Per channel is the widest mode, so this covers whichever one gets picked later.
+    for (int stream = 0; stream < getNumStreamsFor(ChannelMode::perChannel); stream++) {
+        if (frameQueues[stream] == nullptr) {
+            frameQueues[stream] = std::make_unique<SpectralFrameQueue>(frameQueueCapacity);
+        }
+    }
+
+    for (auto* analyser : analysers) {
+        analyser->setSampleRate(sampleRate);
+    }
+
+    currentChannelMode = channelMode.load();
+    addAnalysers(getNumStreamsFor(currentChannelMode));
+    numStreams = getNumStreamsFor(currentChannelMode);
+    activeChannelMode = currentChannelMode;
+
+    currentPriority = priority.load();
+    startThread(currentPriority);
+}
+
+void AnalysisWorker::release() {
+    stopThread(2000);
+}
+
+void AnalysisWorker::pushSamples(const juce::AudioBuffer<float>& buffer) {
+    sampleQueue.push(buffer);
+}
+
+void AnalysisWorker::setParameters(int _fftOrder, AnalysisConfiguration::Window _window, int _hopSize, float _despecklingCutoff, float _noiseFloorDb, bool _multiResolution) {
+    fftOrder = _fftOrder;
+    window = _window;
+    multiResolution = _multiResolution;
+    hopSize = _hopSize;
+    despecklingCutoff = _despecklingCutoff;
+    noiseFloorDb = _noiseFloorDb;
+}
+
+void AnalysisWorker::setBacklogPolicy(BacklogPolicy _backlogPolicy) {
+    backlogPolicy = _backlogPolicy;
+}
+
+void AnalysisWorker::setAnalysisPriority(juce::Thread::Priority _priority) {
+    priority = _priority;
+}
+
+void AnalysisWorker::setChannelMode(ChannelMode _channelMode) {
+    channelMode = _channelMode;
+}
+
+void AnalysisWorker::setPartialTracking(bool _trackPartials) {
+    trackPartials = _trackPartials;
+}
+
+void AnalysisWorker::setDisplayAxis(FrequencyAxis::Scale _scale, float _minFrequency, float _maxFrequency, int _numRows) {
+    displayScale = _scale;
+    displayMinFrequency = _minFrequency;
+    displayMaxFrequency = _maxFrequency;
+    displayNumRows = _numRows;
+}
+
+int AnalysisWorker::getNumStreams() const {
+    return numStreams.load();
+}
+
+AnalysisWorker::ChannelMode AnalysisWorker::getChannelMode() const {
+    return activeChannelMode.load();
+}
+
+SpectralFrameQueue& AnalysisWorker::getFrameQueue(int stream) {
+    jassert(stream < numStreams.load());
+    return *frameQueues[stream];
+}
+
+void AnalysisWorker::run() {
+    while (!threadShouldExit()) {
+        if (priority.load() != currentPriority) {
+            currentPriority = priority.load();
+            setPriority(currentPriority);
+        }
+
+        if (channelMode.load() != currentChannelMode) {
+            // The streams now mean something else, so start their histories over, but on the same clock.
+            currentChannelMode = channelMode.load();
+            addAnalysers(getNumStreamsFor(currentChannelMode));
+            numStreams = getNumStreamsFor(currentChannelMode);
+            activeChannelMode = currentChannelMode;
+
+            for (auto* analyser : analysers) {
+                analyser->reset();
+                analyser->skip(samplePosition);
+            }
+        }
+
+        if (sampleQueue.getNumReady() == 0) {
+            wait(pollIntervalMs);
+            continue;
+        }
+
+        // Still null for the first few milliseconds after construction, while the cache is being built.
+        bool isMultiResolution = multiResolution.load();
+        auto* configuration = configurations.get(isMultiResolution ? AnalysisConfigurationCache::maxFFTOrder : fftOrder.load(), window.load());
+        auto* multiResolutionConfigurations = isMultiResolution ? &configurations : nullptr;
+
+        // Multi-resolution already has fine bins at the low end, and its sizes assume the full rate.
+        float zoomMaxFrequency = isMultiResolution ? 0.f : displayMaxFrequency.load();
+
+        for (int stream = 0; stream < numStreams.load(); stream++) {
+            analysers[stream]->setMaxFrequency(zoomMaxFrequency);
+            analysers[stream]->updateParameters(configuration, hopSize.load(), despecklingCutoff.load(), noiseFloorDb.load(), multiResolutionConfigurations);
+            analysers[stream]->updateAccumulator(displayScale.load(), displayMinFrequency.load(), displayMaxFrequency.load(), displayNumRows.load());
+            analysers[stream]->setPartialTracking(trackPartials.load());
+        }
+
+        analyseAvailableSamples();
+    }
+}
+
+void AnalysisWorker::analyseAvailableSamples() {
+    int numReady = sampleQueue.getNumReady();
+    bool isBehind = numReady > maxBacklogSamples;
+    auto policy = backlogPolicy.load();
+
+    if (isBehind && policy == BacklogPolicy::dropOldest) {
+        int numToDrop = numReady - maxBacklogSamples;
+        sampleQueue.discard(numToDrop);
+        skip(numToDrop);
+        numReady -= numToDrop;
+    }
+
+    while (numReady > 0 && !threadShouldExit()) {
+        int numRead = sampleQueue.read(chunkBuffer, juce::jmin(numReady, chunkSize));
+        analyseChunk(numRead, isBehind && policy == BacklogPolicy::coalesce);
+        numReady -= numRead;
+    }
+
+    // Whatever the audio thread couldn't fit in the queue is gone, but the frames after it should still line up.
+    auto numOverflowed = sampleQueue.getNumOverflowedSamples();
+
+    if (numOverflowed != numOverflowedSamplesSkipped) {
+        skip(numOverflowed - numOverflowedSamplesSkipped);
+        numOverflowedSamplesSkipped = numOverflowed;
+    }
+}
+
+void AnalysisWorker::analyseChunk(int numSamples, bool coalesce) {
+    if (currentChannelMode == ChannelMode::midSide && numChannels >= 2) {
+        auto* left = chunkBuffer.getReadPointer(0);
+        auto* right = chunkBuffer.getReadPointer(1);
+        auto* mid = midSideBuffer.getWritePointer(0);
+        auto* side = midSideBuffer.getWritePointer(1);
+
+        juce::FloatVectorOperations::add(mid, left, right, numSamples);
+        juce::FloatVectorOperations::multiply(mid, 0.5f, numSamples);
+        juce::FloatVectorOperations::subtract(side, left, right, numSamples);
+        juce::FloatVectorOperations::multiply(side, 0.5f, numSamples);
+
+        streamBuffer = &midSideBuffer;
+    }
+    else {
+        streamBuffer = &chunkBuffer;
+    }
+
+    chunkNumSamples = numSamples;
+    chunkCoalesced = coalesce;
+
+    // Hand every stream but the first to the pool, and do the first one here while they run.
+    int streams = numStreams.load();
+
+    for (int stream = 1; stream < streams; stream++) {
+        pool.addJob(jobs[stream], false);
+    }
+
+    analyseStream(0);
+
+    for (int stream = 1; stream < streams; stream++) {
+        pool.waitForJobToFinish(jobs[stream], -1);
+    }
+
+    samplePosition += numSamples;
+}
+
+void AnalysisWorker::analyseStream(int stream) {
+    analysers[stream]->process(*streamBuffer, stream, 0, chunkNumSamples, *frameQueues[stream], chunkCoalesced);
+}
+
+void AnalysisWorker::skip(juce::int64 numSamples) {
+    for (auto* analyser : analysers) {
+        analyser->skip(numSamples);
+    }
+
+    samplePosition += numSamples;
+}
+
+int AnalysisWorker::getNumStreamsFor(ChannelMode mode) const {
+    if (mode == ChannelMode::midSide) {
+        return juce::jmin(2, numChannels);
+    }
+
+    return numChannels;
+}
+
+void AnalysisWorker::addAnalysers(int numStreamsNeeded) {
+    while (analysers.size() < numStreamsNeeded) {
+        auto* analyser = analysers.add(new SpectralAnalyser((int)sampleRate));
+        analyser->setSampleRate(sampleRate);
+        analyser->setRecorder(&recorder, analysers.size() - 1);
+        analyser->skip(samplePosition);
+    }
+}
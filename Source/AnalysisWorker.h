@@ -0,0 +1,145 @@
+#pragma once
+#include <JuceHeader.h>
+#include "AnalysisConfiguration.h"
+#include "FrequencyAxis.h"
+#include "SampleQueue.h"
+#include "SpectralAnalyser.h"
+#include "SpectralFrameQueue.h"
+#include "SpectralRecorder.h"
+
+// Runs the spectral analysis on its own thread, so the audio thread only has to copy samples into a queue.
+// Every analysed stream (an input channel, or mid / side) has its own analyser and frame queue,
+// and the streams of each chunk are analysed in parallel on a small thread pool.
+class AnalysisWorker : private juce::Thread
+{
+public:
+    // What to do when the analysis falls further behind the audio than maxBacklogSeconds.
+    enum class BacklogPolicy
+    {
+        dropOldest, // skip straight to the most recent audio
+        coalesce    // keep the history intact, but only emit one frame per chunk until caught up
+    };
+
+    // Which signals are analysed.
+    // Stream numbers are the same in the frame queues and in recordings.
+    enum class ChannelMode
+    {
+        perChannel, // one stream per input channel
+        midSide     // (L + R) / 2 and (L - R) / 2 from the first two channels
+    };
+
+    static constexpr double maxBacklogSeconds = 0.1;
+
+    // 7.1 is the widest layout we accept.
+    static constexpr int maxChannels = 8;
+    static constexpr int maxStreams = maxChannels;
+    static constexpr int frameQueueCapacity = 64;
+
+    AnalysisWorker(const AnalysisConfigurationCache& _configurations, SpectralRecorder& _recorder);
+    ~AnalysisWorker() override;
+
+    // Not real-time safe: stops the thread, resizes the input queue and starts again.
+    void prepare(double _sampleRate, int maximumBlockSize, int _numChannels);
+    void release();
+
+    // Audio thread. Copies the block into the input queue and returns.
+    void pushSamples(const juce::AudioBuffer<float>& buffer);
+
+    // Any thread. Picked up by the worker before it analyses the next chunk.
+    // In multi-resolution mode the FFT order is ignored and the hop is the smallest size's.
+    void setParameters(int _fftOrder, AnalysisConfiguration::Window _window, int _hopSize, float _despecklingCutoff, float _noiseFloorDb, bool _multiResolution = false);
+    void setBacklogPolicy(BacklogPolicy _backlogPolicy);
+    void setAnalysisPriority(juce::Thread::Priority _priority);
+    void setChannelMode(ChannelMode _channelMode);
+
+    // Any thread. Whether the frames carry partial tracks, see PartialTracker.
+    void setPartialTracking(bool _trackPartials);
+
+    // Any thread. The display rows the reassigned points are accumulated onto (see ReassignedAccumulator),
+    // numRows being the height of one stream. 0 rows switches the accumulation off.
+    // Outside multi-resolution mode, a low maxFrequency also zooms the analysis in on 0 Hz to maxFrequency by
+    // decimating the input first (see Decimator), which keeps going while no editor is open.
+    void setDisplayAxis(FrequencyAxis::Scale _scale, float _minFrequency, float _maxFrequency, int _numRows);
+
+    // Editor side. Streams below getNumStreams() always have a queue, even while the worker is restarting.
+    // These describe the streams as they are being analysed, which can lag a moment behind setChannelMode().
+    int getNumStreams() const;
+    ChannelMode getChannelMode() const;
+    SpectralFrameQueue& getFrameQueue(int stream);
+
+private:
+    static constexpr int chunkSize = 4096;
+    static constexpr int pollIntervalMs = 2;
+
+    // Analyses one stream of the current chunk on a pool thread. Preallocated, one per stream.
+    class StreamJob : public juce::ThreadPoolJob
+    {
+    public:
+        StreamJob(AnalysisWorker& _worker, int _stream);
+
+        JobStatus runJob() override;
+
+    private:
+        AnalysisWorker& worker;
+        int stream;
+    };
+
+    const AnalysisConfigurationCache& configurations;
+    SpectralRecorder& recorder;
+    SampleQueue sampleQueue;
+    juce::AudioBuffer<float> chunkBuffer;
+    juce::AudioBuffer<float> midSideBuffer;
+    const juce::AudioBuffer<float>* streamBuffer;
+
+    // Queues are only ever added, never removed, so the editor can keep reading the ones it knows about.
+    std::array<std::unique_ptr<SpectralFrameQueue>, maxStreams> frameQueues;
+
+    // Analysers are heavy, so they're only made for the streams a channel mode needs, and only ever added.
+    juce::OwnedArray<SpectralAnalyser> analysers;
+    juce::OwnedArray<StreamJob> jobs;
+
+    double sampleRate;
+    int numChannels;
+    int maxBacklogSamples;
+    juce::int64 numOverflowedSamplesSkipped;
+    juce::int64 samplePosition;
+    juce::Thread::Priority currentPriority;
+    ChannelMode currentChannelMode;
+
+    // State of the chunk currently being analysed, read by the jobs.
+    int chunkNumSamples;
+    bool chunkCoalesced;
+
+    std::atomic<int> numStreams;
+    std::atomic<ChannelMode> activeChannelMode;
+    std::atomic<int> fftOrder;
+    std::atomic<bool> multiResolution;
+    std::atomic<AnalysisConfiguration::Window> window;
+    std::atomic<int> hopSize;
+    std::atomic<float> despecklingCutoff;
+    std::atomic<float> noiseFloorDb;
+    std::atomic<BacklogPolicy> backlogPolicy;
+    std::atomic<juce::Thread::Priority> priority;
+    std::atomic<ChannelMode> channelMode;
+    std::atomic<FrequencyAxis::Scale> displayScale;
+    std::atomic<float> displayMinFrequency;
+    std::atomic<float> displayMaxFrequency;
+    std::atomic<int> displayNumRows;
+    std::atomic<bool> trackPartials;
+
+    // Declared last so its threads are stopped before anything the jobs touch is destroyed.
+    juce::ThreadPool pool;
+
+    void run() override;
+
+    void analyseAvailableSamples();
+    void analyseChunk(int numSamples, bool coalesce);
+    void analyseStream(int stream);
+    void skip(juce::int64 numSamples);
+    int getNumStreamsFor(ChannelMode mode) const;
+
+    // Not real-time safe. Makes sure streams below numStreamsNeeded have an analyser, on the current clock.
+    void addAnalysers(int numStreamsNeeded);
+
+    JUCE_DECLARE_NON_COPYABLE(AnalysisWorker)
+};
@@ -0,0 +1,55 @@
+#include "ByteQueue.h"
+
+// AbstractFifo always keeps one slot free.
+ByteQueue::ByteQueue(int _capacity):
+    fifo(_capacity + 1),
+    buffer((size_t)_capacity + 1)
+{
+}
+
+bool ByteQueue::write(const void* data, int numBytes) {
+    if (fifo.getFreeSpace() < numBytes) {
+        return false;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numBytes, start1, size1, start2, size2);
+
+    auto* source = static_cast<const char*>(data);
+    std::memcpy(buffer + start1, source, (size_t)size1);
+    std::memcpy(buffer + start2, source + size1, (size_t)size2);
+
+    fifo.finishedWrite(size1 + size2);
+    return true;
+}
+
+bool ByteQueue::read(void* destination, int numBytes) {
+    if (!peek(destination, numBytes)) {
+        return false;
+    }
+
+    fifo.finishedRead(numBytes);
+    return true;
+}
+
+bool ByteQueue::peek(void* destination, int numBytes) const {
+    if (fifo.getNumReady() < numBytes) {
+        return false;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(numBytes, start1, size1, start2, size2);
+
+    auto* target = static_cast<char*>(destination);
+    std::memcpy(target, buffer + start1, (size_t)size1);
+    std::memcpy(target + size1, buffer + start2, (size_t)size2);
+    return true;
+}
+
+int ByteQueue::getNumReady() const {
+    return fifo.getNumReady();
+}
+
+void ByteQueue::reset() {
+    fifo.reset();
+}
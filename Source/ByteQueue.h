@@ -0,0 +1,28 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Wait-free single-producer / single-consumer queue of raw bytes.
+// Writes are all or nothing, so the consumer never sees half of a record.
+class ByteQueue
+{
+public:
+    ByteQueue(int _capacity);
+
+    // Producer side. Returns false (and writes nothing) if there isn't room for all of it.
+    bool write(const void* data, int numBytes);
+
+    // Consumer side. Returns false (and reads nothing) if fewer than numBytes are ready.
+    bool read(void* destination, int numBytes);
+    bool peek(void* destination, int numBytes) const;
+
+    int getNumReady() const;
+
+    // Only while neither side is using the queue.
+    void reset();
+
+private:
+    juce::AbstractFifo fifo;
+    juce::HeapBlock<char> buffer;
+
+    JUCE_DECLARE_NON_COPYABLE(ByteQueue)
+};
@@ -0,0 +1,62 @@
+#include "ColourMap.h"
+
+juce::StringArray ColourMap::getNames() {
+    return { "Inferno", "Magma", "Viridis", "Greyscale" };
+}
+
+juce::ColourGradient ColourMap::get(Type type) {
+    switch (type) {
+        case Type::inferno: return inferno();
+        case Type::magma: return magma();
+        case Type::viridis: return viridis();
+        case Type::greyscale: return greyscale();
+    }
+
+    return inferno();
+}
+
+juce::ColourGradient ColourMap::inferno() {
+    juce::ColourGradient gradient;
+    gradient.addColour(0.0, juce::Colour::fromRGB(0, 0, 4));
+    gradient.addColour(0.14, juce::Colour::fromRGB(40, 11, 84));
+    gradient.addColour(0.29, juce::Colour::fromRGB(101, 21, 110));
+    gradient.addColour(0.43, juce::Colour::fromRGB(159, 42, 99));
+    gradient.addColour(0.57, juce::Colour::fromRGB(212, 72, 66));
+    gradient.addColour(0.71, juce::Colour::fromRGB(245, 125, 21));
+    gradient.addColour(0.88, juce::Colour::fromRGB(250, 193, 39));
+    gradient.addColour(1.f, juce::Colour::fromRGB(252, 255, 164));
+    return gradient;
+}
+
+juce::ColourGradient ColourMap::magma() {
+    juce::ColourGradient gradient;
+    gradient.addColour(0.0, juce::Colour::fromRGB(0, 0, 4));
+    gradient.addColour(0.14, juce::Colour::fromRGB(30, 17, 74));
+    gradient.addColour(0.29, juce::Colour::fromRGB(85, 20, 125));
+    gradient.addColour(0.43, juce::Colour::fromRGB(137, 40, 129));
+    gradient.addColour(0.57, juce::Colour::fromRGB(190, 56, 118));
+    gradient.addColour(0.71, juce::Colour::fromRGB(238, 90, 95));
+    gradient.addColour(0.86, juce::Colour::fromRGB(254, 160, 109));
+    gradient.addColour(1.f, juce::Colour::fromRGB(252, 253, 191));
+    return gradient;
+}
+
+juce::ColourGradient ColourMap::viridis() {
+    juce::ColourGradient gradient;
+    gradient.addColour(0.0, juce::Colour::fromRGB(68, 1, 84));
+    gradient.addColour(0.14, juce::Colour::fromRGB(70, 50, 127));
+    gradient.addColour(0.29, juce::Colour::fromRGB(54, 92, 141));
+    gradient.addColour(0.43, juce::Colour::fromRGB(39, 127, 142));
+    gradient.addColour(0.57, juce::Colour::fromRGB(31, 161, 135));
+    gradient.addColour(0.71, juce::Colour::fromRGB(74, 194, 109));
+    gradient.addColour(0.86, juce::Colour::fromRGB(159, 218, 58));
+    gradient.addColour(1.f, juce::Colour::fromRGB(253, 231, 37));
+    return gradient;
+}
+
+juce::ColourGradient ColourMap::greyscale() {
+    juce::ColourGradient gradient;
+    gradient.addColour(0.0, juce::Colours::black);
+    gradient.addColour(1.f, juce::Colours::white);
+    return gradient;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Colour maps shared by the editor and the offline tools, so they render the same data the same way.
+namespace ColourMap
+{
+    // In the order of the editor's "Colour Map" choices.
+    enum class Type
+    {
+        inferno = 0,
+        magma,
+        viridis,
+        greyscale
+    };
+
+    juce::StringArray getNames();
+
+    juce::ColourGradient get(Type type);
+
+    juce::ColourGradient inferno();
+    juce::ColourGradient magma();
+    juce::ColourGradient viridis();
+    juce::ColourGradient greyscale();
+}
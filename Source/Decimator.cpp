@@ -0,0 +1,118 @@
+#include "Decimator.h"
+
+// Kaiser window for about 80 dB of stopband, which with 47 taps puts the transition between 0.195 and 0.305 of
+// the input rate. Halving the rate folds anything at f above 0.25 down to 0.5 - f, so the stopband lands at 0.195
+// and below, 80 dB down, while the transition band lands on 0.195 to 0.25 only partly attenuated. That's the
+// top quarter of the output's band, hence usableFraction.
+static constexpr double kaiserBeta = 7.86;
+
+static double besselI0(double x) {
+    double quarterSquare = x * x * 0.25;
+    double term = 1.0;
+    double sum = 1.0;
+
+    for (int k = 1; k < 64 && term > 1.0e-17 * sum; k++) {
+        term *= quarterSquare / ((double)k * (double)k);
+        sum += term;
+    }
+
+    return sum;
+}
+
+Decimator::Decimator():
+    numStages(0)
+{
+    // A windowed sinc with its cutoff at a quarter of the input rate, which is 0 on every even tap but the centre.
+    for (int i = 0; i < (int)oddTaps.size(); i++) {
+        int n = 2 * i + 1;
+        double u = (double)n / centreTap;
+        double sinc = std::sin(juce::MathConstants<double>::halfPi * n) / (juce::MathConstants<double>::pi * n);
+        oddTaps[(size_t)i] = (float)(sinc * besselI0(kaiserBeta * std::sqrt(1.0 - u * u)) / besselI0(kaiserBeta));
+    }
+
+    reset();
+}
+
+int Decimator::getFactorFor(double sampleRate, float maxFrequency) {
+    int factor = 1;
+
+    while (maxFrequency > 0 && factor < maxFactor && maxFrequency <= usableFraction * sampleRate / (4.0 * factor)) {
+        factor *= 2;
+    }
+
+    return factor;
+}
+
+void Decimator::setFactor(int _factor) {
+    jassert(juce::isPowerOfTwo(_factor) && _factor <= maxFactor);
+    numStages = juce::findHighestSetBit((juce::uint32)juce::jlimit(1, maxFactor, _factor));
+    reset();
+}
+
+int Decimator::getFactor() const {
+    return 1 << numStages;
+}
+
+void Decimator::reset() {
+    for (auto& stage : stages) {
+        stage.history.fill(0.f);
+        stage.writePosition = 0;
+        stage.hasHalfPair = false;
+    }
+}
+
+int Decimator::process(const float* input, int numSamples, float* output) {
+    if (numStages == 0) {
+        std::copy(input, input + numSamples, output);
+        return numSamples;
+    }
+
+    // After the first stage the rest work in place, as none of them write ahead of where they read.
+    numSamples = processStage(stages[0], input, numSamples, output);
+
+    for (int stage = 1; stage < numStages; stage++) {
+        numSamples = processStage(stages[(size_t)stage], output, numSamples, output);
+    }
+
+    return numSamples;
+}
+
+int Decimator::getLatency() const {
+    int latency = 0;
+
+    for (int stage = 0; stage < numStages; stage++) {
+        latency += (centreTap + (stages[(size_t)stage].hasHalfPair ? 1 : 0)) << stage;
+    }
+
+    return latency;
+}
+
+int Decimator::processStage(Stage& stage, const float* input, int numSamples, float* output) const {
+    int numOutputs = 0;
+
+    for (int i = 0; i < numSamples; i++) {
+        stage.history[(size_t)stage.writePosition] = input[i];
+        stage.history[(size_t)(stage.writePosition + numTaps)] = input[i];
+        stage.writePosition = (stage.writePosition + 1) % numTaps;
+
+        // Only every other output is kept, so only those are worked out.
+        stage.hasHalfPair = !stage.hasHalfPair;
+
+        if (stage.hasHalfPair) {
+            continue;
+        }
+
+        // The latest numTaps samples, oldest first.
+        const float* window = stage.history.data() + stage.writePosition;
+        float sum = 0.5f * window[centreTap];
+
+        for (int tap = 0; tap < (int)oddTaps.size(); tap++) {
+            int offset = 2 * tap + 1;
+            sum += oddTaps[(size_t)tap] * (window[centreTap - offset] + window[centreTap + offset]);
+        }
+
+        output[numOutputs++] = sum;
+    }
+
+    return numOutputs;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Low-passes and downsamples by a power of two, as a cascade of half-band FIR stages that each halve the rate.
+// A half-band filter has every other tap zero, and each stage only computes the outputs it keeps, so the
+// whole cascade costs about twice its first stage. Put in front of the analysis it zooms in on the low end:
+// an FFT of the decimated stream has the bins of one factor times bigger, for the cost of a small one.
+// Below usableFraction of the output's Nyquist, anything aliased is more than 80 dB down.
+class Decimator
+{
+public:
+    static constexpr int maxStages = 7;
+    static constexpr int maxFactor = 1 << maxStages;
+    static constexpr float usableFraction = 0.75f;
+
+    Decimator();
+
+    // The largest factor that still leaves maxFrequency in the usable band, 1 for the whole band (or 0 Hz).
+    static int getFactorFor(double sampleRate, float maxFrequency);
+
+    // Also clears the filters' history.
+    void setFactor(int _factor);
+    int getFactor() const;
+
+    void reset();
+
+    // Returns how many samples were written to output, at most numSamples / factor rounded up.
+    // The output can be the input.
+    int process(const float* input, int numSamples, float* output);
+
+    // How many input samples ago the newest output was centred: the filters' delay plus the inputs that haven't
+    // made an output yet.
+    int getLatency() const;
+
+private:
+    static constexpr int numTaps = 47;
+    static constexpr int centreTap = numTaps / 2;
+
+    struct Stage
+    {
+        // Twice the taps, written at both ends, so the latest numTaps are always one contiguous run.
+        std::array<float, 2 * numTaps> history;
+        int writePosition = 0;
+        bool hasHalfPair = false;
+    };
+
+    // The odd taps either side of the centre, which are the same both sides. The centre tap is a half.
+    std::array<float, (centreTap + 1) / 2> oddTaps;
+
+    std::array<Stage, maxStages> stages;
+    int numStages;
+
+    int processStage(Stage& stage, const float* input, int numSamples, float* output) const;
+
+    JUCE_DECLARE_NON_COPYABLE(Decimator)
+};
@@ -1,178 +1,131 @@
-#pragma once
 #include "FFTDataGenerator.h"
 
-FFTDataGenerator::FFTDataGenerator(int _fftSize, int _sampleRate):
-    fftSize(_fftSize),
-    fft(std::log2(_fftSize)),
-    standardWindow(_fftSize, 0.0f),
-    derivativeWindow(_fftSize, 0.0f),
-    timeWeightedWindow(_fftSize, 0.0f),
-    derivativeTimeWeightedWindow(_fftSize, 0.0f),
-    sampleRate(_sampleRate),
+static_assert((1 << AnalysisConfigurationCache::maxFFTOrder) == SpectralFrame::maxFFTSize,
+              "The workspace and the frame storage must agree on the largest FFT size");
+
+static constexpr int workspaceAlignment = 64;
+static constexpr int maxFFTSize = SpectralFrame::maxFFTSize;
+static constexpr int maxBins = SpectralFrame::maxBins;
+
+FFTDataGenerator::FFTDataGenerator(int _sampleRate):
+    fftSize(0),
+    sampleRate((float)_sampleRate),
+    configuration(nullptr),
     despecklingCutoff(2.f)
 {
-    updateParameters(_fftSize, 2.f);
+    // Two full-size packed buffers, then the four half spectra as eight split real / imaginary arrays,
+    // each starting on its own aligned boundary.
+    size_t packedBytes = maxFFTSize * sizeof(std::complex<float>);
+    size_t splitBytes = maxBins * sizeof(float);
+
+    workspaceMemory.calloc(workspaceAlignment + 2 * packedBytes + splitSpectra.size() * splitBytes);
+
+    char* next = juce::snapPointerToAlignment(workspaceMemory.get(), workspaceAlignment);
+    packedInput = reinterpret_cast<std::complex<float>*>(next);
+    next += packedBytes;
+    packedOutput = reinterpret_cast<std::complex<float>*>(next);
+    next += packedBytes;
+
+    for (auto& spectrum : splitSpectra) {
+        spectrum = reinterpret_cast<float*>(next);
+        next += splitBytes;
+    }
 }
 
 void FFTDataGenerator::reassignedSpectrogram(
-    juce::AudioBuffer<float>& buffer,
-    std::vector<float>& times,
-    std::vector<float>& frequencies,
-    std::vector<float>& magnitudes,
-    std::vector<float>& standardFFTResult
+    const juce::AudioBuffer<float>& buffer,
+    SpectralFrame& frame
 ) {
-    int bufferSize = buffer.getNumSamples();
-    auto spectrumHann = doFFT(buffer, standardWindow);
-
-    auto spectrumHannDerivative = doFFT(buffer, derivativeWindow);
-    auto spectumHannTimeWeighted = doFFT(buffer, timeWeightedWindow);
-    auto spectrumHannDerivativeTimeWeighted = doFFT(buffer, derivativeTimeWeightedWindow);
-
-    float currentFrequency = 0.f;
-    float frequencyCorrectionRadians = 0.f;
-    float frequencyCorrectionHz = 0.f;
-    float correctedTimeSeconds = 0.f;
-    float magnitude = 0.f;
-    float currentTimeSeconds = 0.f;
-    float fftBinSize = (float)sampleRate / (float)fftSize;
-    float pi = 3.14159265358979;
-    float totalTimeSeconds = (float)bufferSize / (float)sampleRate;
-    float mixedPartialPhaseDerivative = 0.f;
-    float magnitudeSquared = 0.f;
-
-    std::complex<float> X;
-    std::complex<float> X_Dh;
-    std::complex<float> X_Th;
-    std::complex<float> X_T_Dh;
-    std::vector<float> mixedDerivative(fftSize / 2, 0.f);
-
-    resizeIfNecessary(times, fftSize / 2);
-    resizeIfNecessary(frequencies, fftSize / 2);
-    resizeIfNecessary(magnitudes, fftSize / 2);
-    resizeIfNecessary(standardFFTResult, fftSize / 2);
-
-    for (int frequencyBin = 0; frequencyBin < fftSize / 2; frequencyBin++) {
-        currentFrequency = frequencyBin * fftBinSize;
-        X = spectrumHann[frequencyBin];
-        X_Dh = spectrumHannDerivative[frequencyBin];
-        X_Th = spectumHannTimeWeighted[frequencyBin];
-        X_T_Dh = spectrumHannDerivativeTimeWeighted[frequencyBin];
-        magnitude = std::abs(X);
-        magnitudeSquared = magnitude * magnitude;
-
-        standardFFTResult[frequencyBin] = juce::Decibels::gainToDecibels(2 * magnitude);
-            
-        if (magnitude == 0) {
-            continue;
-        }
-        
-        float t1 = std::real(X_T_Dh * std::conj(X) / magnitudeSquared);
-        float t2 = std::real(X_Th * X_Dh / magnitudeSquared);
-
-        mixedPartialPhaseDerivative = t1 - t2;
-        mixedDerivative[frequencyBin] = mixedPartialPhaseDerivative;
-
-        if (std::abs(mixedPartialPhaseDerivative) > despecklingCutoff) {
-            magnitude = 0; // filter it out.
-        }
-
-        frequencyCorrectionRadians = -std::imag(X_Dh / X);
-        frequencyCorrectionHz = frequencyCorrectionRadians * sampleRate / (2 * pi);
-        correctedTimeSeconds = std::real(X_Th / X) / sampleRate;
-
-        times[frequencyBin] = correctedTimeSeconds;
-        frequencies[frequencyBin] = currentFrequency + frequencyCorrectionHz;
-
-        // in Gain, such that a known reassigned sine wave at an amplitude of 1 gets a magnitude of 1.
-        // I'm not sure where the other factor of 2 is coming from.
-        magnitudes[frequencyBin] = juce::Decibels::gainToDecibels(2 * magnitude); 
-    }
-} 
-
-void FFTDataGenerator::updateParameters(float _fftSize, float _despecklingCutoff) {
-    despecklingCutoff = _despecklingCutoff;
-    fftSize = _fftSize;
-    fft = juce::dsp::FFT(std::log2(_fftSize));
-
-    resizeIfNecessary(standardWindow, fftSize);
-    juce::dsp::WindowingFunction<float>::fillWindowingTables(standardWindow.data(), _fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris, false);
-    updateTimeWeightedWindow();
-    updateDerivativeWindow();
-    updateDerivativeTimeWeightedWindow();
+    jassert(fftSize / 2 <= SpectralFrame::maxBins);
+    jassert(buffer.getNumSamples() >= fftSize);
+
+    frame.fftSize = fftSize;
+    frame.numBins = fftSize / 2;
+    frame.numPoints = fftSize / 2;
+
+    reassignedSpectrogram(
+        buffer.getReadPointer(0),
+        frame.times.data(),
+        frame.frequencies.data(),
+        frame.magnitudes.data(),
+        frame.standardFFTResult.data()
+    );
 }
 
-void FFTDataGenerator::updateTimeWeightedWindow() {
-    resizeIfNecessary(timeWeightedWindow, fftSize);
-
-    int halfWidth = fftSize / 2;
-    int index = 0;
-
-    float maxValue = 0.f;
-
-    // The center should be time = 0.
-    for (int time = -halfWidth; time < halfWidth; time++) {
-        index = time + halfWidth;
-        float newValue = standardWindow[index] * time;
-        timeWeightedWindow[index] = newValue;
-
-        if (timeWeightedWindow[index] > maxValue) {
-            maxValue = newValue;
-        }
-    }
-
-    // There should be some math to calculate it without having to normalize the values.
-    for (int i = 0; i < fftSize; i++) {
-        timeWeightedWindow[i] = timeWeightedWindow[i] / maxValue;
-    }
+void FFTDataGenerator::reassignedSpectrogram(
+    const float* input,
+    float* times,
+    float* frequencies,
+    float* magnitudes,
+    float* standardFFTResult
+) {
+    jassert(configuration != nullptr);
+
+    ReassignmentSpectra spectra;
+    spectra.real = splitSpectra[0];
+    spectra.imag = splitSpectra[1];
+    spectra.derivativeReal = splitSpectra[2];
+    spectra.derivativeImag = splitSpectra[3];
+    spectra.timeWeightedReal = splitSpectra[4];
+    spectra.timeWeightedImag = splitSpectra[5];
+    spectra.derivativeTimeWeightedReal = splitSpectra[6];
+    spectra.derivativeTimeWeightedImag = splitSpectra[7];
+
+    doFFT(input, configuration->standardWindow.data(), configuration->derivativeWindow.data(), configuration->derivativeWindowGain, splitSpectra[0], splitSpectra[1], splitSpectra[2], splitSpectra[3]);
+    doFFT(input, configuration->timeWeightedWindow.data(), configuration->derivativeTimeWeightedWindow.data(), configuration->derivativeTimeWeightedWindowGain, splitSpectra[4], splitSpectra[5], splitSpectra[6], splitSpectra[7]);
+
+    // Magnitudes are in gain, such that a known reassigned sine wave at an amplitude of 1 gets a magnitude of 1.
+    // I'm not sure where the other factor of 2 is coming from.
+    float fftBinSize = sampleRate / (float)fftSize;
+    ReassignmentKernel::process(spectra, fftSize / 2, sampleRate, fftBinSize, despecklingCutoff, times, frequencies, magnitudes, standardFFTResult);
 }
 
-void FFTDataGenerator::updateDerivativeWindow() {
-    resizeIfNecessary(derivativeWindow, fftSize);
-
-    for (int i = 0; i < fftSize; i++)
-    {
-        if (i == 0 || i == fftSize - 1) {
-            derivativeWindow[i] = 0;
-            continue;
-        }
-
-        derivativeWindow[i] = (standardWindow[i + 1] - standardWindow[i - 1]) / 2.0;
-    }
+void FFTDataGenerator::setSampleRate(float _sampleRate) {
+    sampleRate = _sampleRate;
 }
 
-void FFTDataGenerator::updateDerivativeTimeWeightedWindow() {
-    resizeIfNecessary(derivativeTimeWeightedWindow, fftSize);
+void FFTDataGenerator::updateParameters(const AnalysisConfiguration& _configuration, float _despecklingCutoff) {
+    configuration = &_configuration;
+    fftSize = _configuration.fftSize;
 
-    for (int i = 0; i < fftSize; i++)
-    {
-        derivativeTimeWeightedWindow[i] = derivativeWindow[i] * i;
+    if (fft == nullptr || fft->getSize() != fftSize) {
+        fft = std::make_unique<juce::dsp::FFT>(_configuration.fftOrder);
     }
-}
 
-void FFTDataGenerator::resizeIfNecessary(std::vector<float>& vector, int size) {
-    if (vector.size() != size) {
-        vector.resize(size, 0.f);
-    }
+    despecklingCutoff = _despecklingCutoff;
 }
 
-std::vector<std::complex<float>> FFTDataGenerator::doFFT(const juce::AudioBuffer<float>& inputBuffer, std::vector<float>& window) {
-    std::vector<std::complex<float>> frame(fftSize, 0.0f);
-    std::vector<std::complex<float>> fftResult(fftSize, 0.0f);
-    
-    const float* inputChannelData = inputBuffer.getReadPointer(0);
-
+void FFTDataGenerator::doFFT(
+    const float* input,
+    const float* windowA,
+    const float* windowB,
+    float windowBGain,
+    float* spectrumAReal,
+    float* spectrumAImag,
+    float* spectrumBReal,
+    float* spectrumBImag
+) {
     for (int i = 0; i < fftSize; i++) {
-        frame[i] = inputChannelData[i] * window[i];
+        packedInput[i] = std::complex<float>(input[i] * windowA[i], input[i] * windowB[i] * windowBGain);
     }
 
     // Perform FFT
-    fft.perform(frame.data(), fftResult.data(), false);
+    fft->perform(packedInput, packedOutput, false);
 
-    // Normalize the values by the FFT size, and multiply by 2 
+    // With Z = FFT(a + ib):  A[k] = (Z[k] + conj(Z[N - k])) / 2  and  B[k] = (Z[k] - conj(Z[N - k])) / 2i.
+    // Normalize the values by the FFT size, and multiply by 2
     // because we are splitting the energy between positive and negative frequencies.
-    for (int i = 0; i < fftSize; i++) {
-        fftResult[i] /= (fftSize / 2);
+    // Together with the halves above that is a plain division by the FFT size.
+    float scale = 1.f / fftSize;
+    float scaleB = scale / windowBGain;
+
+    for (int k = 0; k < fftSize / 2; k++) {
+        std::complex<float> z = packedOutput[k];
+        std::complex<float> zMirror = packedOutput[(fftSize - k) & (fftSize - 1)];
+
+        spectrumAReal[k] = (z.real() + zMirror.real()) * scale;
+        spectrumAImag[k] = (z.imag() - zMirror.imag()) * scale;
+        spectrumBReal[k] = (z.imag() + zMirror.imag()) * scaleB;
+        spectrumBImag[k] = (zMirror.real() - z.real()) * scaleB;
     }
-
-    return fftResult;
-}
\ No newline at end of file
+}
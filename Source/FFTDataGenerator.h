@@ -1,42 +1,67 @@
 #pragma once
 #include <JuceHeader.h>
+#include "AnalysisConfiguration.h"
+#include "ReassignmentKernel.h"
+#include "SpectralFrame.h"
 
 class FFTDataGenerator
 {
 public:
     int fftSize;
 
-    FFTDataGenerator(int _fftSize, int _sampleRate);
+    FFTDataGenerator(int _sampleRate);
 
+    // One point per bin, see ReassignmentKernel::keepPoints() for dropping the quiet ones.
     void reassignedSpectrogram(
-        juce::AudioBuffer<float>& buffer,
-        std::vector<float>& times,
-        std::vector<float>& frequencies,
-        std::vector<float>& magnitudes,
-        std::vector<float>& standardFFTResult
+        const juce::AudioBuffer<float>& buffer,
+        SpectralFrame& frame
     );
 
-    void updateTimeWeightedWindow();
-
-    void updateDerivativeWindow();
-
-    void updateDerivativeTimeWeightedWindow();
+    // Non-allocating core. Reads fftSize samples from input and writes fftSize / 2 values into each output.
+    void reassignedSpectrogram(
+        const float* input,
+        float* times,
+        float* frequencies,
+        float* magnitudes,
+        float* standardFFTResult
+    );
 
-    std::vector<std::complex<float>> doFFT(
-        const juce::AudioBuffer<float>&inputBuffer, 
-        std::vector<float>& window
+    // Transforms the input under two different windows with a single complex FFT, and returns the
+    // positive half of both spectra as split real / imaginary arrays. The two windowed frames are real,
+    // so one rides in the real part and the other in the imaginary part, and they are separated using
+    // the conjugate symmetry of real signals.
+    // windowB is scaled by windowBGain while packed and back again after, see AnalysisConfiguration.
+    void doFFT(
+        const float* input,
+        const float* windowA,
+        const float* windowB,
+        float windowBGain,
+        float* spectrumAReal,
+        float* spectrumAImag,
+        float* spectrumBReal,
+        float* spectrumBImag
     );
 
-    void FFTDataGenerator::resizeIfNecessary(std::vector<float>& vector, int size);
+    // The rate of the samples it's given, when that isn't the one it was made with (see Decimator).
+    void setSampleRate(float _sampleRate);
 
-    void FFTDataGenerator::updateParameters(float despeckleCutoff, float fftSize);
+    // The configuration is owned elsewhere (see AnalysisConfigurationCache) and must outlive this generator.
+    // Not real-time safe when the FFT size changes, which plans a new FFT.
+    void updateParameters(const AnalysisConfiguration& _configuration, float _despecklingCutoff);
 
 private:
-    int sampleRate;
-    std::vector<float> standardWindow;
-    std::vector<float> derivativeWindow;
-    std::vector<float> timeWeightedWindow;
-    std::vector<float> derivativeTimeWeightedWindow;
-    juce::dsp::FFT fft;
+    float sampleRate;
+    const AnalysisConfiguration* configuration;
     float despecklingCutoff;
-};
\ No newline at end of file
+
+    // This generator's own plan, so generators on different threads never share one.
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    // Scratch space for the largest supported FFT, allocated once so the hot path never has to.
+    juce::HeapBlock<char> workspaceMemory;
+    std::complex<float>* packedInput;
+    std::complex<float>* packedOutput;
+    std::array<float*, 8> splitSpectra;
+
+    JUCE_DECLARE_NON_COPYABLE(FFTDataGenerator)
+};
@@ -0,0 +1,133 @@
+#include "FrequencyAxis.h"
+
+juce::StringArray FrequencyAxis::getScaleNames() {
+    return { "Linear", "Log", "Mel", "Bark" };
+}
+
+FrequencyAxis::FrequencyAxis():
+    scale(Scale::log),
+    minFrequency(0),
+    maxFrequency(0),
+    height(0),
+    fftSize(0),
+    sampleRate(0)
+{
+}
+
+bool FrequencyAxis::update(Scale _scale, float _minFrequency, float _maxFrequency, int _height, int _fftSize, float _sampleRate) {
+    if (_scale == scale && _minFrequency == minFrequency && _maxFrequency == maxFrequency
+        && _height == height && _fftSize == fftSize && _sampleRate == sampleRate) {
+        return false;
+    }
+
+    jassert(_maxFrequency > _minFrequency);
+    jassert(_scale != Scale::log || _minFrequency > 0);
+
+    scale = _scale;
+    minFrequency = _minFrequency;
+    maxFrequency = _maxFrequency;
+    height = _height;
+    fftSize = _fftSize;
+    sampleRate = _sampleRate;
+
+    rebuild();
+    return true;
+}
+
+int FrequencyAxis::getBinRowStart(int bin) const {
+    jassert(bin < (int)binRowStarts.size());
+    return binRowStarts[(size_t)bin];
+}
+
+int FrequencyAxis::getBinRowEnd(int bin) const {
+    jassert(bin < (int)binRowEnds.size());
+    return binRowEnds[(size_t)bin];
+}
+
+int FrequencyAxis::getRow(float frequency) const {
+    // Written so NaN fails too.
+    if (rowBoundaries.empty() || !(frequency > rowBoundaries.front() && frequency < rowBoundaries.back())) {
+        return -1;
+    }
+
+    // Row 0 starts at the first boundary but reaches down to the one before it, like truncation would.
+    return (int)(std::upper_bound(rowBoundaries.begin() + 2, rowBoundaries.end() - 1, frequency) - (rowBoundaries.begin() + 2));
+}
+
+float FrequencyAxis::getRowPosition(float frequency) const {
+    if (rowBoundaries.empty() || !(frequency > rowBoundaries.front() && frequency < rowBoundaries.back())) {
+        return -1.f;
+    }
+
+    auto above = std::upper_bound(rowBoundaries.begin(), rowBoundaries.end(), frequency);
+    auto below = above - 1;
+    int row = (int)(below - rowBoundaries.begin()) - 1;
+
+    return row + (frequency - *below) / (*above - *below);
+}
+
+float FrequencyAxis::getPosition(float frequency) const {
+    float warpedMin = warp(minFrequency);
+    return (warp(frequency) - warpedMin) / (warp(maxFrequency) - warpedMin);
+}
+
+float FrequencyAxis::getFrequency(float position) const {
+    float warpedMin = warp(minFrequency);
+    return unwarp(warpedMin + position * (warp(maxFrequency) - warpedMin));
+}
+
+float FrequencyAxis::warp(float frequency) const {
+    switch (scale) {
+        case Scale::linear: return frequency;
+        case Scale::log: return std::log(frequency);
+        case Scale::mel: return 2595.f * std::log10(1.f + frequency / 700.f);
+        case Scale::bark: return 26.81f * frequency / (1960.f + frequency) - 0.53f; // Traunmüller's approximation
+    }
+
+    return frequency;
+}
+
+float FrequencyAxis::unwarp(float warped) const {
+    switch (scale) {
+        case Scale::linear: return warped;
+        case Scale::log: return std::exp(warped);
+        case Scale::mel: return 700.f * (std::pow(10.f, warped / 2595.f) - 1.f);
+        case Scale::bark: return warped < 26.28f ? 1960.f * (warped + 0.53f) / (26.28f - warped) : std::numeric_limits<float>::infinity();
+    }
+
+    return warped;
+}
+
+void FrequencyAxis::rebuild() {
+    // The standard view stretches bin i up to where bin i + 1 starts, over the full height of the image.
+    size_t numBins = (size_t)(fftSize / 2 + 1);
+    float binSize = sampleRate / fftSize;
+    int binRowStart = 0;
+
+    binRowStarts.resize(numBins);
+    binRowEnds.resize(numBins);
+
+    for (size_t i = 0; i < numBins; i++) {
+        float position = juce::jlimit(-1.f, 2.f, getPosition((i + 1) * binSize));
+        int binRowEnd = static_cast<int>(position * height);
+
+        binRowStarts[i] = juce::jlimit(0, height, binRowStart);
+        binRowEnds[i] = juce::jlimit(binRowStarts[i], height, binRowEnd);
+        binRowStart = binRowEnd;
+    }
+
+    // Reassigned points put maxFrequency on the top row, and round towards the bottom one, so row k starts
+    // where the position reaches k / (height - 1).
+    rowBoundaries.clear();
+
+    if (height < 2) {
+        return;
+    }
+
+    float rowScale = (float)(height - 1);
+    rowBoundaries.reserve((size_t)height + 2);
+
+    for (int row = -1; row <= height; row++) {
+        rowBoundaries.push_back(getFrequency(row / rowScale));
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Maps frequencies onto the rows of the spectrogram. Everything the renderer needs per frame is
+// precomputed into tables, which are only rebuilt when the scale, range, height, FFT size or sample rate
+// changes, so drawing a frame doesn't involve any logs.
+class FrequencyAxis
+{
+public:
+    // In the order of the editor's "Frequency Scale" choices.
+    enum class Scale
+    {
+        linear = 0,
+        log,
+        mel,
+        bark
+    };
+
+    static juce::StringArray getScaleNames();
+
+    FrequencyAxis();
+
+    // Cheap if nothing changed. Returns true if the tables were rebuilt.
+    bool update(Scale _scale, float _minFrequency, float _maxFrequency, int _height, int _fftSize, float _sampleRate);
+
+    // The rows (0 at the bottom) FFT bin `bin` fills in the standard view, [start, end), clipped to the image.
+    // Empty when the bin shares its row with the one below it.
+    int getBinRowStart(int bin) const;
+    int getBinRowEnd(int bin) const;
+
+    // The row (0 at the bottom) a reassigned frequency lands on, or -1 if it's off the axis.
+    int getRow(float frequency) const;
+
+    // The same, but continuous: row r covers [r, r + 1). Interpolated between the row boundaries, so it's
+    // piecewise linear in frequency. Anything off the axis comes out at -1 or below.
+    float getRowPosition(float frequency) const;
+
+    // Where a frequency sits on the axis, 0 at minFrequency and 1 at maxFrequency, and back. Exact, but slow.
+    float getPosition(float frequency) const;
+    float getFrequency(float position) const;
+
+private:
+    Scale scale;
+    float minFrequency;
+    float maxFrequency;
+    int height;
+    int fftSize;
+    float sampleRate;
+
+    std::vector<int> binRowStarts;
+    std::vector<int> binRowEnds;
+
+    // rowBoundaries[k] is the lowest frequency on row k - 1, from just below row 0 to just above the top row.
+    // Sorted, so finding a row is a binary search. Frequencies outside the first and last aren't on any row.
+    std::vector<float> rowBoundaries;
+
+    float warp(float frequency) const;
+    float unwarp(float warped) const;
+
+    void rebuild();
+
+    JUCE_DECLARE_NON_COPYABLE(FrequencyAxis)
+};
@@ -0,0 +1,164 @@
+#include "MultiResolutionAnalysis.h"
+
+static constexpr int largestFFTSize = 1 << AnalysisConfigurationCache::maxFFTOrder;
+static constexpr float silenceDb = -100.f;
+
+static_assert(largestFFTSize == SpectralFrame::maxFFTSize, "Fused frames use the largest size's bins");
+
+MultiResolutionAnalysis::Resolution::Resolution(int _sampleRate):
+    generator(_sampleRate),
+    configuration(nullptr),
+    isFresh(false),
+    firstBin(0),
+    endBin(0)
+{
+    times.fill(0.f);
+    frequencies.fill(0.f);
+    magnitudes.fill(silenceDb);
+    standardFFTResult.fill(silenceDb);
+}
+
+MultiResolutionAnalysis::MultiResolutionAnalysis(int _sampleRate):
+    sampleRate(0.f),
+    windowBuffer(1, SpectralFrame::maxFFTSize),
+    hopCount(0)
+{
+    for (int resolution = 0; resolution < numResolutions; resolution++) {
+        resolutions.add(new Resolution(_sampleRate));
+    }
+
+    setSampleRate((float)_sampleRate);
+}
+
+void MultiResolutionAnalysis::setSampleRate(float _sampleRate) {
+    sampleRate = _sampleRate;
+
+    // The bands are in Hz, so which bins they take moves with the rate.
+    for (int resolution = 0; resolution < numResolutions; resolution++) {
+        auto* r = resolutions[resolution];
+        r->generator.setSampleRate(sampleRate);
+        float binSize = sampleRate / (float)getFFTSize(resolution);
+        int numBins = getFFTSize(resolution) / 2;
+
+        // A bin belongs to the band its centre falls in.
+        float ceiling = resolution == 0 ? sampleRate : getBandFloor(resolution - 1);
+        r->firstBin = juce::jlimit(0, numBins, (int)std::ceil(getBandFloor(resolution) / binSize));
+        r->endBin = juce::jlimit(0, numBins, (int)std::ceil(ceiling / binSize));
+    }
+
+    float largestBinSize = sampleRate / (float)largestFFTSize;
+
+    for (int bin = 0; bin < SpectralFrame::maxBins; bin++) {
+        int resolution = 0;
+
+        while (resolution < numResolutions - 1 && bin * largestBinSize < getBandFloor(resolution)) {
+            resolution++;
+        }
+
+        binResolutions[(size_t)bin] = (juce::uint8)resolution;
+    }
+}
+
+void MultiResolutionAnalysis::updateParameters(const AnalysisConfigurationCache& configurations, AnalysisConfiguration::Window window, float despecklingCutoff) {
+    for (int resolution = 0; resolution < numResolutions; resolution++) {
+        auto& r = *resolutions[resolution];
+        auto* configuration = configurations.get(AnalysisConfigurationCache::minFFTOrder + resolution, window);
+
+        if (configuration != nullptr) {
+            r.configuration = configuration;
+            r.generator.updateParameters(*configuration, despecklingCutoff);
+        }
+    }
+}
+
+bool MultiResolutionAnalysis::isReady() const {
+    for (auto* resolution : resolutions) {
+        if (resolution->configuration == nullptr) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void MultiResolutionAnalysis::reset() {
+    hopCount = 0;
+
+    for (auto* resolution : resolutions) {
+        resolution->isFresh = false;
+        resolution->standardFFTResult.fill(silenceDb);
+    }
+}
+
+void MultiResolutionAnalysis::analyse(const AnalysisRingBuffer& ringBuffer, SpectralFrame& frame, bool everySize) {
+    jassert(isReady());
+
+    for (int resolution = 0; resolution < numResolutions; resolution++) {
+        auto& r = *resolutions[resolution];
+        int period = 1 << resolution;
+
+        // The smallest size runs every hop, 2048 on odd hops, 4096 on every fourth starting at 2 and 8192 on every
+        // eighth starting at 4, so the big ones never land on the same hop.
+        r.isFresh = everySize || resolution == 0 || (hopCount & (period - 1)) == period / 2;
+
+        if (r.isFresh) {
+            ringBuffer.copyLatest(windowBuffer, r.configuration->fftSize);
+            r.generator.reassignedSpectrogram(
+                windowBuffer.getReadPointer(0),
+                r.times.data(),
+                r.frequencies.data(),
+                r.magnitudes.data(),
+                r.standardFFTResult.data()
+            );
+        }
+    }
+
+    hopCount++;
+    fuse(frame);
+}
+
+float MultiResolutionAnalysis::getBandFloor(int resolution) {
+    // Each size down the list has half the bins, so it starts two octaves higher.
+    static constexpr std::array<float, numResolutions> floors { 4000.f, 1000.f, 250.f, 0.f };
+    return floors[(size_t)resolution];
+}
+
+int MultiResolutionAnalysis::getFFTSize(int resolution) {
+    return 1 << (AnalysisConfigurationCache::minFFTOrder + resolution);
+}
+
+void MultiResolutionAnalysis::fuse(SpectralFrame& frame) const {
+    frame.fftSize = largestFFTSize;
+    frame.numBins = largestFFTSize / 2;
+
+    // A smaller size's bin covers several of the fused bins, which all take its value.
+    for (int bin = 0; bin < frame.numBins; bin++) {
+        int resolution = binResolutions[(size_t)bin];
+        int sourceBin = bin >> (numResolutions - 1 - resolution);
+        frame.standardFFTResult[(size_t)bin] = resolutions[resolution]->standardFFTResult[(size_t)sourceBin];
+    }
+
+    // The bands don't overlap and no size has finer bins than the largest, so the points always fit.
+    int numPoints = 0;
+
+    for (int resolution = 0; resolution < numResolutions; resolution++) {
+        auto& r = *resolutions[resolution];
+
+        if (!r.isFresh) {
+            continue;
+        }
+
+        // A shorter window ends in the same place, so its centre is this much later.
+        float timeShift = (float)(largestFFTSize - getFFTSize(resolution)) * 0.5f / sampleRate;
+
+        for (int bin = r.firstBin; bin < r.endBin; bin++) {
+            frame.times[(size_t)numPoints] = r.times[(size_t)bin] + timeShift;
+            frame.frequencies[(size_t)numPoints] = r.frequencies[(size_t)bin];
+            frame.magnitudes[(size_t)numPoints] = r.magnitudes[(size_t)bin];
+            numPoints++;
+        }
+    }
+
+    jassert(numPoints <= frame.numBins);
+    frame.numPoints = numPoints;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <JuceHeader.h>
+#include "AnalysisConfiguration.h"
+#include "AnalysisRingBuffer.h"
+#include "FFTDataGenerator.h"
+#include "SpectralFrame.h"
+
+// Runs every supported FFT size over the same ring and fuses them into one frame per hop, taking each band from
+// the size that suits it: the longest window below 250 Hz, then shorter ones up to the shortest above 4 kHz.
+// The hop is the smallest size's, and each size only runs every size / smallest size hops, staggered so no hop
+// analyses more than two of them. That's about four small FFTs a hop, where the largest size at that hop would be 8 big ones.
+// Fused frames come out on the largest size's bins. The points of a size are only sent with the hop that analysed
+// them, moved in time so they're relative to the largest window's centre like everything else in the frame.
+class MultiResolutionAnalysis
+{
+public:
+    static constexpr int numResolutions = AnalysisConfigurationCache::numFFTOrders;
+
+    MultiResolutionAnalysis(int _sampleRate);
+
+    // Call reset() after, the latest analyses were at the old rate.
+    void setSampleRate(float _sampleRate);
+
+    // Picks up whichever sizes the cache has built so far for this window.
+    void updateParameters(const AnalysisConfigurationCache& configurations, AnalysisConfiguration::Window window, float despecklingCutoff);
+
+    // Whether every size has its configuration yet.
+    bool isReady() const;
+
+    void reset();
+
+    // Call once per hop. With everySize (e.g. when coalescing a backlog into one frame) all sizes are analysed now.
+    void analyse(const AnalysisRingBuffer& ringBuffer, SpectralFrame& frame, bool everySize = false);
+
+    // The lowest frequency each size is used for, smallest size first.
+    static float getBandFloor(int resolution);
+
+private:
+    struct Resolution
+    {
+        Resolution(int _sampleRate);
+
+        FFTDataGenerator generator;
+        const AnalysisConfiguration* configuration;
+
+        // The latest analysis of this size. Its standard magnitudes fill in until the next one.
+        std::array<float, SpectralFrame::maxBins> times;
+        std::array<float, SpectralFrame::maxBins> frequencies;
+        std::array<float, SpectralFrame::maxBins> magnitudes;
+        std::array<float, SpectralFrame::maxBins> standardFFTResult;
+
+        bool isFresh;
+        int firstBin;
+        int endBin;
+    };
+
+    float sampleRate;
+    juce::OwnedArray<Resolution> resolutions;
+    juce::AudioBuffer<float> windowBuffer;
+    juce::int64 hopCount;
+
+    // Which size each of the fused frame's bins comes from.
+    std::array<juce::uint8, SpectralFrame::maxBins> binResolutions;
+
+    static int getFFTSize(int resolution);
+
+    void fuse(SpectralFrame& frame) const;
+
+    JUCE_DECLARE_NON_COPYABLE(MultiResolutionAnalysis)
+};
@@ -0,0 +1,280 @@
+#include "PartialTracker.h"
+
+PartialTracker::PartialTracker():
+    numTracks(0),
+    numEndedTracks(0),
+    nextId(0),
+    bucketStarts(maxBuckets + 1, 0),
+    sortedPoints(SpectralFrame::maxBins, 0),
+    peaks(SpectralFrame::maxBins),
+    numPeaks(0),
+    bucketFirstPeaks(maxBuckets + 1, 0),
+    peakOwners(SpectralFrame::maxBins, -1),
+    births(SpectralFrame::maxBins, 0)
+{
+    trackChoices.fill(-1);
+    trackDistances.fill(0.f);
+}
+
+void PartialTracker::reset() {
+    numTracks = 0;
+    numEndedTracks = 0;
+    numPeaks = 0;
+}
+
+int PartialTracker::getNumTracks() const {
+    return numTracks;
+}
+
+const PartialTracker::Track& PartialTracker::getTrack(int index) const {
+    jassert(index >= 0 && index < numTracks);
+    return tracks[(size_t)index].track;
+}
+
+int PartialTracker::getNumEndedTracks() const {
+    return numEndedTracks;
+}
+
+const PartialTracker::Track& PartialTracker::getEndedTrack(int index) const {
+    jassert(index >= 0 && index < numEndedTracks);
+    return endedTracks[(size_t)index];
+}
+
+void PartialTracker::process(SpectralFrame& frame) {
+    frame.numPartialSegments = 0;
+    numEndedTracks = 0;
+
+    if (frame.fftSize == 0) {
+        return;
+    }
+
+    // The points' times are from the middle of the window, which covers fftSize * decimation input samples.
+    float binSize = frame.sampleRate / (float)frame.decimation / (float)frame.fftSize;
+    float linkTolerance = linkToleranceBins * binSize;
+    double frameTime = (double)(frame.samplePosition - (juce::int64)frame.fftSize * frame.decimation / 2) / frame.sampleRate;
+    int numBuckets = juce::jmin(maxBuckets, (int)(frame.fftSize / 2 / linkToleranceBins) + 2);
+
+    findPeaks(frame, linkTolerance, numBuckets, peakToleranceBins * binSize);
+
+    // Every track picks the peak nearest to where it's heading, and where two pick the same one the confirmed
+    // or else the nearer keeps it.
+    std::fill(peakOwners.begin(), peakOwners.begin() + numPeaks, -1);
+
+    for (int t = 0; t < numTracks; t++) {
+        const auto& state = tracks[(size_t)t];
+        float frequency = state.track.frequency + state.slope * (float)(frameTime - state.lastFrameTime);
+        int bucket = juce::jlimit(0, numBuckets - 1, (int)(frequency / linkTolerance));
+        int first = bucketFirstPeaks[(size_t)juce::jmax(0, bucket - 1)];
+        int end = bucketFirstPeaks[(size_t)juce::jmin(numBuckets, bucket + 2)];
+        int choice = -1;
+        float distance = linkTolerance;
+
+        for (int p = first; p < end; p++) {
+            float d = std::abs(peaks[(size_t)p].frequency - frequency);
+
+            if (d <= distance) {
+                choice = p;
+                distance = d;
+            }
+        }
+
+        trackChoices[(size_t)t] = choice;
+        trackDistances[(size_t)t] = distance;
+
+        if (choice >= 0) {
+            int owner = peakOwners[(size_t)choice];
+            bool isConfirmed = state.track.isConfirmed();
+
+            if (owner < 0
+                || (isConfirmed && !tracks[(size_t)owner].track.isConfirmed())
+                || (isConfirmed == tracks[(size_t)owner].track.isConfirmed() && distance < trackDistances[(size_t)owner])) {
+                peakOwners[(size_t)choice] = t;
+            }
+        }
+    }
+
+    // Carry on the tracks that got their peak, and let the rest miss a frame, dropping the ones that have missed
+    // too many. Kept in order, so the oldest tracks win ties next frame too.
+    int numKept = 0;
+
+    for (int t = 0; t < numTracks; t++) {
+        auto& state = tracks[(size_t)t];
+        int choice = trackChoices[(size_t)t];
+
+        if (choice >= 0 && peakOwners[(size_t)choice] == t) {
+            extendTrack(state, peaks[(size_t)choice], frameTime, frame);
+        }
+        else if (++state.track.numMissedFrames > maxMissedFrames) {
+            if (state.track.isConfirmed()) {
+                endedTracks[(size_t)numEndedTracks++] = state.track;
+            }
+
+            continue;
+        }
+
+        if (numKept != t) {
+            tracks[(size_t)numKept] = state;
+        }
+
+        numKept++;
+    }
+
+    numTracks = numKept;
+
+    // Whatever's left starts a track, the loudest first if there isn't room for all of them.
+    int numBirths = 0;
+
+    for (int p = 0; p < numPeaks; p++) {
+        if (peakOwners[(size_t)p] < 0) {
+            births[(size_t)numBirths++] = p;
+        }
+    }
+
+    int numFree = maxTracks - numTracks;
+
+    if (numBirths > numFree) {
+        std::nth_element(births.begin(), births.begin() + numFree, births.begin() + numBirths, [this](int a, int b) {
+            return peaks[(size_t)a].magnitude > peaks[(size_t)b].magnitude;
+        });
+        numBirths = numFree;
+    }
+
+    for (int i = 0; i < numBirths; i++) {
+        const auto& peak = peaks[(size_t)births[(size_t)i]];
+        Point point { frameTime + peak.time, peak.frequency, peak.magnitude };
+        auto& state = tracks[(size_t)numTracks++];
+
+        state.track.id = nextId++;
+        state.track.startTime = point.time;
+        state.track.endTime = point.time;
+        state.track.frequency = point.frequency;
+        state.track.magnitude = point.magnitude;
+        state.track.numFrames = 1;
+        state.track.numMissedFrames = 0;
+        state.slope = 0.f;
+        state.lastFrameTime = frameTime;
+        state.firstPoints[0] = point;
+        state.lastPoint = point;
+    }
+}
+
+void PartialTracker::findPeaks(const SpectralFrame& frame, float bucketWidth, int numBuckets, float peakTolerance) {
+    // Counting sort into the buckets, then an insertion sort that only has to fix up the order within each one.
+    std::fill(bucketStarts.begin(), bucketStarts.begin() + numBuckets + 1, 0);
+
+    auto getBucket = [&](float frequency) {
+        return juce::jlimit(0, numBuckets - 1, (int)(frequency / bucketWidth));
+    };
+
+    int numPoints = 0;
+
+    for (int i = 0; i < frame.numPoints; i++) {
+        float frequency = frame.frequencies[(size_t)i];
+
+        // Points pushed below 0 Hz or that came out as NaN can't be part of anything.
+        if (frequency > 0.f) {
+            bucketStarts[(size_t)getBucket(frequency) + 1]++;
+            numPoints++;
+        }
+    }
+
+    for (int b = 1; b <= numBuckets; b++) {
+        bucketStarts[(size_t)b] += bucketStarts[(size_t)b - 1];
+    }
+
+    for (int i = 0; i < frame.numPoints; i++) {
+        float frequency = frame.frequencies[(size_t)i];
+
+        if (frequency > 0.f) {
+            sortedPoints[(size_t)bucketStarts[(size_t)getBucket(frequency)]++] = i;
+        }
+    }
+
+    for (int i = 1; i < numPoints; i++) {
+        int point = sortedPoints[(size_t)i];
+        float frequency = frame.frequencies[(size_t)point];
+        int j = i;
+
+        for (; j > 0 && frame.frequencies[(size_t)sortedPoints[(size_t)j - 1]] > frequency; j--) {
+            sortedPoints[(size_t)j] = sortedPoints[(size_t)j - 1];
+        }
+
+        sortedPoints[(size_t)j] = point;
+    }
+
+    // Points within peakTolerance of the first in a run are one peak, at the loudest of them. The next run starts
+    // further than that from this one's first point, so the peaks stay in frequency order.
+    numPeaks = 0;
+    float runStart = 0.f;
+
+    for (int i = 0; i < numPoints; i++) {
+        int point = sortedPoints[(size_t)i];
+        Peak peak { frame.times[(size_t)point], frame.frequencies[(size_t)point], frame.magnitudes[(size_t)point] };
+
+        if (numPeaks > 0 && peak.frequency - runStart <= peakTolerance) {
+            if (peak.magnitude > peaks[(size_t)numPeaks - 1].magnitude) {
+                peaks[(size_t)numPeaks - 1] = peak;
+            }
+
+            continue;
+        }
+
+        runStart = peak.frequency;
+        peaks[(size_t)numPeaks++] = peak;
+    }
+
+    int peak = 0;
+
+    for (int b = 0; b <= numBuckets; b++) {
+        while (peak < numPeaks && getBucket(peaks[(size_t)peak].frequency) < b) {
+            peak++;
+        }
+
+        bucketFirstPeaks[(size_t)b] = peak;
+    }
+}
+
+void PartialTracker::extendTrack(TrackState& state, const Peak& peak, double frameTime, SpectralFrame& frame) {
+    Point point { frameTime + peak.time, peak.frequency, peak.magnitude };
+    auto& track = state.track;
+
+    if (track.numFrames < minFrames) {
+        state.firstPoints[(size_t)track.numFrames] = point;
+    }
+
+    if (frameTime > state.lastFrameTime) {
+        state.slope = (point.frequency - track.frequency) / (float)(frameTime - state.lastFrameTime);
+    }
+
+    state.lastFrameTime = frameTime;
+    track.numFrames++;
+    track.numMissedFrames = 0;
+    track.endTime = point.time;
+    track.frequency = point.frequency;
+    track.magnitude = point.magnitude;
+
+    if (track.numFrames == minFrames) {
+        for (int i = 1; i < minFrames; i++) {
+            addSegment(frame, track.id, state.firstPoints[(size_t)i - 1], state.firstPoints[(size_t)i], frameTime);
+        }
+    }
+    else if (track.numFrames > minFrames) {
+        addSegment(frame, track.id, state.lastPoint, point, frameTime);
+    }
+
+    state.lastPoint = point;
+}
+
+void PartialTracker::addSegment(SpectralFrame& frame, int trackId, const Point& start, const Point& end, double frameTime) {
+    if (frame.numPartialSegments == SpectralFrame::maxPartialSegments) {
+        return;
+    }
+
+    auto& segment = frame.partialSegments[(size_t)frame.numPartialSegments++];
+    segment.trackId = trackId;
+    segment.startTime = (float)(start.time - frameTime);
+    segment.startFrequency = start.frequency;
+    segment.endTime = (float)(end.time - frameTime);
+    segment.endFrequency = end.frequency;
+    segment.magnitude = end.magnitude;
+}
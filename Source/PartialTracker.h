@@ -0,0 +1,122 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpectralFrame.h"
+
+// Links the reassigned points of consecutive frames into partials. Each frame's points are merged into peaks, and
+// every track carries on to the nearest peak within linkToleranceBins of where its slope says it should be. When
+// two tracks want the same peak a confirmed one beats one that isn't yet, otherwise the nearer gets it, so a stray
+// point next to a partial can't steal it. Peaks nobody claims start new tracks, and tracks that go unmatched for
+// more than maxMissedFrames frames die.
+// The peaks are counting-sorted by frequency into buckets one tolerance wide, so a track only has to look at its
+// own bucket and the two either side, and a frame costs O(points) rather than tracks * points.
+// A track isn't shown until it's lasted minFrames frames, and then everything it's linked so far comes out at
+// once, so noise that happens to line up for a frame never makes it to the display.
+// Nothing allocates after construction.
+class PartialTracker
+{
+public:
+    static constexpr int maxTracks = 256;
+    static constexpr int minFrames = 3;
+    static constexpr int maxMissedFrames = 2;
+
+    // How far a track can move from one frame to the next, and how close points have to be to be the same peak.
+    static constexpr float linkToleranceBins = 2.f;
+    static constexpr float peakToleranceBins = 0.5f;
+
+    struct Track
+    {
+        int id = 0;
+
+        // In seconds on the frames' sample clock, of the first point and the latest.
+        double startTime = 0.0;
+        double endTime = 0.0;
+
+        // The latest point's, and its magnitude in dB.
+        float frequency = 0.f;
+        float magnitude = 0.f;
+
+        int numFrames = 0;
+        int numMissedFrames = 0;
+
+        // Whether it's lasted long enough to be shown.
+        bool isConfirmed() const { return numFrames >= minFrames; }
+    };
+
+    PartialTracker();
+
+    void reset();
+
+    // Links the frame's points onto the tracks and replaces its partial segments with the pieces of track it added.
+    // Frames have to come in order, and on one clock (reset when the rate or decimation changes).
+    void process(SpectralFrame& frame);
+
+    // The tracks alive after the last frame, confirmed or not, oldest first.
+    int getNumTracks() const;
+    const Track& getTrack(int index) const;
+
+    // The confirmed tracks that died in the last frame.
+    int getNumEndedTracks() const;
+    const Track& getEndedTrack(int index) const;
+
+private:
+    static constexpr int maxBuckets = (int)(SpectralFrame::maxBins / linkToleranceBins) + 2;
+
+    static_assert(maxTracks * (minFrames - 1) <= SpectralFrame::maxPartialSegments,
+                  "every track confirmed in one frame has to fit its segments");
+
+    // Time is relative to the frame's centre, like the points.
+    struct Peak
+    {
+        float time;
+        float frequency;
+        float magnitude;
+    };
+
+    struct Point
+    {
+        double time;
+        float frequency;
+        float magnitude;
+    };
+
+    struct TrackState
+    {
+        Track track;
+
+        // In Hz per second, from the last two frames it matched, and the latest of those frames' times.
+        float slope;
+        double lastFrameTime;
+
+        // Held back until the track is confirmed.
+        std::array<Point, minFrames> firstPoints;
+        Point lastPoint;
+    };
+
+    std::array<TrackState, maxTracks> tracks;
+    int numTracks;
+    std::array<Track, maxTracks> endedTracks;
+    int numEndedTracks;
+    int nextId;
+
+    // The current frame's points in frequency order, and the peaks made from them, with where each bucket's peaks
+    // start (numBuckets + 1 of them, the last being numPeaks).
+    std::vector<int> bucketStarts;
+    std::vector<int> sortedPoints;
+    std::vector<Peak> peaks;
+    int numPeaks;
+    std::vector<int> bucketFirstPeaks;
+
+    // Which track gets each peak (-1 for none), and which peak each track wanted and how far away it was.
+    std::vector<int> peakOwners;
+    std::array<int, maxTracks> trackChoices;
+    std::array<float, maxTracks> trackDistances;
+    std::vector<int> births;
+
+    void findPeaks(const SpectralFrame& frame, float bucketWidth, int numBuckets, float peakTolerance);
+
+    void extendTrack(TrackState& state, const Peak& peak, double frameTime, SpectralFrame& frame);
+
+    static void addSegment(SpectralFrame& frame, int trackId, const Point& start, const Point& end, double frameTime);
+
+    JUCE_DECLARE_NON_COPYABLE(PartialTracker)
+};
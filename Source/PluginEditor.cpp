@@ -13,45 +13,160 @@
 SpectrogramVSTAudioProcessorEditor::SpectrogramVSTAudioProcessorEditor (SpectrogramVSTAudioProcessor& p)
     :   AudioProcessorEditor(&p),
         audioProcessor(p),
-        sampleRate(48000),
-        refreshRateHz(240),
-        spectrogramImagePos(0),
+        spectrogramComponent(p),
         despecklingCutoffSliderAttachment(audioProcessor.apvts, "Despeckling Cutoff", despecklingCutoffSlider),
         noiseFloorSliderAttachment(audioProcessor.apvts, "Noise Floor", noiseFloorSlider),
         fftSizeComboBoxAttachment(audioProcessor.apvts, "FFT Size", fftSizeComboBox),
-        useReassignmentComboBoxAttachment(audioProcessor.apvts, "Reassignment Enabled", useReassignmentComboBox)
+        fftSizeUnitComboBoxAttachment(audioProcessor.apvts, "FFT Size Unit", fftSizeUnitComboBox),
+        hopSizeComboBoxAttachment(audioProcessor.apvts, "Hop Size", hopSizeComboBox),
+        windowComboBoxAttachment(audioProcessor.apvts, "Window", windowComboBox),
+        analysisPriorityComboBoxAttachment(audioProcessor.apvts, "Analysis Priority", analysisPriorityComboBox),
+        backlogPolicyComboBoxAttachment(audioProcessor.apvts, "Backlog Policy", backlogPolicyComboBox),
+        channelModeComboBoxAttachment(audioProcessor.apvts, "Channel Mode", channelModeComboBox),
+        streamDisplayComboBoxAttachment(audioProcessor.apvts, "Stream Display", streamDisplayComboBox),
+        colourMapComboBoxAttachment(audioProcessor.apvts, "Colour Map", colourMapComboBox),
+        frequencyScaleComboBoxAttachment(audioProcessor.apvts, "Frequency Scale", frequencyScaleComboBox),
+        scrollSpeedComboBoxAttachment(audioProcessor.apvts, "Scroll Speed", scrollSpeedComboBox),
+        maxFrequencyComboBoxAttachment(audioProcessor.apvts, "Max Frequency", maxFrequencyComboBox),
+        useReassignmentComboBoxAttachment(audioProcessor.apvts, "Reassignment Enabled", useReassignmentComboBox),
+        trackPartialsComboBoxAttachment(audioProcessor.apvts, "Track Partials", trackPartialsComboBox),
+        showsFFTDurations(false)
 {
 
+    addAndMakeVisible(spectrogramComponent);
     addAndMakeVisible(noiseFloorSlider);
     addAndMakeVisible(despecklingCutoffSlider);
     addAndMakeVisible(fftSizeComboBox);
+    addAndMakeVisible(fftSizeUnitComboBox);
+    addAndMakeVisible(hopSizeComboBox);
+    addAndMakeVisible(windowComboBox);
+    addAndMakeVisible(analysisPriorityComboBox);
+    addAndMakeVisible(backlogPolicyComboBox);
+    addAndMakeVisible(channelModeComboBox);
+    addAndMakeVisible(streamDisplayComboBox);
+    addAndMakeVisible(colourMapComboBox);
+    addAndMakeVisible(frequencyScaleComboBox);
+    addAndMakeVisible(scrollSpeedComboBox);
+    addAndMakeVisible(maxFrequencyComboBox);
     addAndMakeVisible(useReassignmentComboBox);
+    addAndMakeVisible(trackPartialsComboBox);
+    addAndMakeVisible(recordButton);
+    addAndMakeVisible(recordingLabel);
 
     addAndMakeVisible(noiseFloorSliderLabel);
     addAndMakeVisible(despecklingCutoffLabel);
     addAndMakeVisible(fftSizeComboBoxLabel);
+    addAndMakeVisible(fftSizeUnitComboBoxLabel);
+    addAndMakeVisible(hopSizeComboBoxLabel);
+    addAndMakeVisible(windowComboBoxLabel);
+    addAndMakeVisible(analysisPriorityComboBoxLabel);
+    addAndMakeVisible(backlogPolicyComboBoxLabel);
+    addAndMakeVisible(channelModeComboBoxLabel);
+    addAndMakeVisible(streamDisplayComboBoxLabel);
+    addAndMakeVisible(colourMapComboBoxLabel);
+    addAndMakeVisible(frequencyScaleComboBoxLabel);
+    addAndMakeVisible(scrollSpeedComboBoxLabel);
+    addAndMakeVisible(maxFrequencyComboBoxLabel);
+    addAndMakeVisible(trackPartialsComboBoxLabel);
 
     fftSizeComboBox.addItem("1024", 1);
     fftSizeComboBox.addItem("2048", 2);
     fftSizeComboBox.addItem("4096", 3);
     fftSizeComboBox.addItem("8192", 4);
+    fftSizeComboBox.addItem("Multi-resolution", 5);
+
+    fftSizeUnitComboBox.addItem("Samples", 1);
+    fftSizeUnitComboBox.addItem("Duration", 2);
+
+    hopSizeComboBox.addItem("FFT Size / 4", 1);
+    hopSizeComboBox.addItem("FFT Size / 8", 2);
+    hopSizeComboBox.addItem("FFT Size / 16", 3);
+    hopSizeComboBox.addItem("64 samples", 4);
+    hopSizeComboBox.addItem("32 samples", 5);
+    hopSizeComboBox.addItem("16 samples", 6);
+
+    windowComboBox.addItemList(AnalysisConfiguration::getWindowNames(), 1);
+
+    analysisPriorityComboBox.addItem("Low", 1);
+    analysisPriorityComboBox.addItem("Normal", 2);
+    analysisPriorityComboBox.addItem("High", 3);
+
+    backlogPolicyComboBox.addItem("Drop Oldest", 1);
+    backlogPolicyComboBox.addItem("Coalesce", 2);
+
+    channelModeComboBox.addItem("Per Channel", 1);
+    channelModeComboBox.addItem("Mid / Side", 2);
+
+    streamDisplayComboBox.addItem("Overlay", 1);
+    streamDisplayComboBox.addItem("Side by Side", 2);
+
+    colourMapComboBox.addItemList(ColourMap::getNames(), 1);
+
+    frequencyScaleComboBox.addItemList(FrequencyAxis::getScaleNames(), 1);
+
+    scrollSpeedComboBox.addItem("60 px/s", 1);
+    scrollSpeedComboBox.addItem("120 px/s", 2);
+    scrollSpeedComboBox.addItem("240 px/s", 3);
+    scrollSpeedComboBox.addItem("480 px/s", 4);
+    scrollSpeedComboBox.addItem("960 px/s", 5);
+
+    maxFrequencyComboBox.addItem("Full", 1);
+    maxFrequencyComboBox.addItem("8 kHz", 2);
+    maxFrequencyComboBox.addItem("4 kHz", 3);
+    maxFrequencyComboBox.addItem("2 kHz", 4);
+    maxFrequencyComboBox.addItem("1 kHz", 5);
+    maxFrequencyComboBox.addItem("500 Hz", 6);
+    maxFrequencyComboBox.addItem("250 Hz", 7);
 
     useReassignmentComboBox.addItem("No", 1);
     useReassignmentComboBox.addItem("Yes", 2);
 
+    trackPartialsComboBox.addItem("No", 1);
+    trackPartialsComboBox.addItem("Yes", 2);
+
     noiseFloorSliderLabel.setText("Noise Floor (dB)", juce::dontSendNotification);
     despecklingCutoffLabel.setText("Despeckling Cutoff", juce::dontSendNotification);
     fftSizeComboBoxLabel.setText("FFT Size", juce::dontSendNotification);
+    fftSizeUnitComboBoxLabel.setText("FFT Size Unit", juce::dontSendNotification);
+    hopSizeComboBoxLabel.setText("Hop Size", juce::dontSendNotification);
+    windowComboBoxLabel.setText("Window", juce::dontSendNotification);
+    analysisPriorityComboBoxLabel.setText("Analysis Priority", juce::dontSendNotification);
+    backlogPolicyComboBoxLabel.setText("Backlog Policy", juce::dontSendNotification);
+    channelModeComboBoxLabel.setText("Channels", juce::dontSendNotification);
+    streamDisplayComboBoxLabel.setText("Display", juce::dontSendNotification);
+    colourMapComboBoxLabel.setText("Colour Map", juce::dontSendNotification);
+    frequencyScaleComboBoxLabel.setText("Frequency Scale", juce::dontSendNotification);
+    scrollSpeedComboBoxLabel.setText("Scroll Speed", juce::dontSendNotification);
+    maxFrequencyComboBoxLabel.setText("Max Frequency", juce::dontSendNotification);
     useReassignmentComboBoxLabel.setText("Reassignment Enabled", juce::dontSendNotification);
+    trackPartialsComboBoxLabel.setText("Track Partials", juce::dontSendNotification);
 
     noiseFloorSliderLabel.attachToComponent(&noiseFloorSlider, true);
     despecklingCutoffLabel.attachToComponent(&despecklingCutoffSlider, true);
     fftSizeComboBoxLabel.attachToComponent(&fftSizeComboBox, true);
+    fftSizeUnitComboBoxLabel.attachToComponent(&fftSizeUnitComboBox, true);
+    hopSizeComboBoxLabel.attachToComponent(&hopSizeComboBox, true);
+    windowComboBoxLabel.attachToComponent(&windowComboBox, true);
+    analysisPriorityComboBoxLabel.attachToComponent(&analysisPriorityComboBox, true);
+    backlogPolicyComboBoxLabel.attachToComponent(&backlogPolicyComboBox, true);
+    channelModeComboBoxLabel.attachToComponent(&channelModeComboBox, true);
+    streamDisplayComboBoxLabel.attachToComponent(&streamDisplayComboBox, true);
+    colourMapComboBoxLabel.attachToComponent(&colourMapComboBox, true);
+    frequencyScaleComboBoxLabel.attachToComponent(&frequencyScaleComboBox, true);
+    scrollSpeedComboBoxLabel.attachToComponent(&scrollSpeedComboBox, true);
+    maxFrequencyComboBoxLabel.attachToComponent(&maxFrequencyComboBox, true);
     useReassignmentComboBoxLabel.attachToComponent(&useReassignmentComboBox, true);
+    trackPartialsComboBoxLabel.attachToComponent(&trackPartialsComboBox, true);
+
+    recordButton.onClick = [this] { toggleRecording(); };
+    recordingLabel.setFont(12.f);
+    updateRecordingControls();
+    updateFFTSizeNames();
+
+    setSize(862, 608);
 
-    setSize(862, 512);
-    initializeColorMap();
-    startTimerHz(refreshRateHz);
+    // The spectrogram follows the display by itself, this is only for the recording controls and the FFT size names.
+    startTimerHz(4);
 }
 
 SpectrogramVSTAudioProcessorEditor::~SpectrogramVSTAudioProcessorEditor()
@@ -61,145 +176,85 @@ SpectrogramVSTAudioProcessorEditor::~SpectrogramVSTAudioProcessorEditor()
 //==============================================================================
 void SpectrogramVSTAudioProcessorEditor::paint (juce::Graphics& g)
 {
-    drawSpectrogram(g, juce::Rectangle(0, 0, 512, 512));
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
 }
 
-inline int mapFrequencyToPixel(float frequency, float minFreq, float maxFreq, int minHeight, int maxHeight) {
-    // Uses a logarithmic transform instead of a linear one.
-    return static_cast<int>((std::log(frequency / minFreq) / std::log(maxFreq / minFreq)) * (maxHeight - minHeight) + minHeight);
-}
-
-void SpectrogramVSTAudioProcessorEditor::updateSpectrogram() {
-    // Display the spectral frame using only the FFT result.
-    int spectrogramHeight = spectrogramImage.getHeight();
-    int spectrogramWidth = spectrogramImage.getWidth();
-    int binPixelStart = 0;
-    int binPixelEnd = spectrogramHeight;
-
-    float minFrequency = 20.f;
-    float maxFrequency = 24000.f;
-    float minMagnitudeDb = audioProcessor.noiseFloorDb;
-    float maxMagnitudeDb = -14.9f;
-    float binSize = sampleRate / audioProcessor.fftSize;
-    float currentBinFrequency = 0;
-    float currentBinMagnitude = 0;
-    float normalizedMagnitude = 0;
-
-    for (int i = 0; i < audioProcessor.standardFFTResult.size(); i++) {
-        currentBinMagnitude = juce::jlimit(minMagnitudeDb, maxMagnitudeDb, audioProcessor.standardFFTResult[i]);
-        currentBinFrequency = (i + 1) * binSize;
-        binPixelEnd = mapFrequencyToPixel(currentBinFrequency, minFrequency, maxFrequency, 0, spectrogramHeight);
-        normalizedMagnitude = juce::jmap<float>(currentBinMagnitude, minMagnitudeDb, maxMagnitudeDb, 0.0f, 1.0f);
-
-        for (int y = binPixelStart; y < binPixelEnd; y++) {
-            if (y < spectrogramHeight) {
-                spectrogramImage.setPixelAt(spectrogramImagePos, spectrogramHeight - y, infernoGradient.getColourAtPosition(normalizedMagnitude));
-            }
-        }
-
-        binPixelStart = binPixelEnd;
+void SpectrogramVSTAudioProcessorEditor::timerCallback()
+{
+    // The recorder stops by itself if the disk fills up.
+    if (recordButton.getToggleState() != audioProcessor.isRecording()) {
+        updateRecordingControls();
     }
 
-    spectrogramImagePos += 1;
-
-    if (spectrogramImagePos >= spectrogramWidth) {
-        spectrogramImagePos = 0;
+    if ((audioProcessor.apvts.getRawParameterValue("FFT Size Unit")->load() == 1) != showsFFTDurations) {
+        updateFFTSizeNames();
     }
 }
 
-void SpectrogramVSTAudioProcessorEditor::updateSpectrogramReassigned() {
-    // Define the height and width of the spectrogram image
-    int spectrogramHeight = spectrogramImage.getHeight();
-    int spectrogramWidth = spectrogramImage.getWidth();
+void SpectrogramVSTAudioProcessorEditor::updateFFTSizeNames() {
+    showsFFTDurations = audioProcessor.apvts.getRawParameterValue("FFT Size Unit")->load() == 1;
 
-    if (spectrogramHeight == 0 || spectrogramWidth == 0) {
-        return;
+    for (int i = 0; i < 4; i++) {
+        int size = 1 << (10 + i);
+        auto name = showsFFTDurations ? juce::String(juce::roundToInt(1000.0 * size / SpectrogramVSTAudioProcessor::fftDurationReferenceRate)) + " ms"
+                                      : juce::String(size);
+        fftSizeComboBox.changeItemText(i + 1, name);
     }
 
-    float minFrequency = 20.f;
-    float maxFrequency = 24000.f;
-    float minMagnitudeDb = audioProcessor.noiseFloorDb;
-    float maxMagnitudeDb = -14.9f;
-    float pixelsPerSecond = 1 / refreshRateHz;
-    std::vector<float> largestMagnitudeForY(spectrogramHeight, 0.f);
-    int x;
-    int y;
-
-    // Clear out the old pixels
-    for (y = 0; y < spectrogramHeight; y++) {
-        spectrogramImage.setPixelAt(spectrogramImagePos, y, juce::Colour::greyLevel(0));
-    }
+    // Setting the same item again is what updates the text showing.
+    fftSizeComboBox.setSelectedId(fftSizeComboBox.getSelectedId(), juce::dontSendNotification);
+}
 
-    // Draw the new stuff
-    for (int i = 0; i < audioProcessor.magnitudes.size(); i++) {
-        x = spectrogramImagePos + audioProcessor.times[i] / pixelsPerSecond;
-        x %= spectrogramWidth;
-        y = spectrogramHeight - mapFrequencyToPixel(audioProcessor.frequencies[i], minFrequency, maxFrequency, 0, spectrogramHeight - 1);
-
-        if (x >= 0 && x < spectrogramWidth && y >= 0 && y < spectrogramHeight)
-        {
-            float magnitude = juce::jlimit(minMagnitudeDb, maxMagnitudeDb, audioProcessor.magnitudes[i]);
-            float normalizedMagnitude = juce::jmap<float>(magnitude, minMagnitudeDb, maxMagnitudeDb, 0.0f, 1.0f);
-
-            if (normalizedMagnitude > 0 && normalizedMagnitude > largestMagnitudeForY[y]) {
-                spectrogramImage.setPixelAt(x, y, infernoGradient.getColourAtPosition(normalizedMagnitude));
-                largestMagnitudeForY[y] = normalizedMagnitude;
-            }
-        }
+void SpectrogramVSTAudioProcessorEditor::toggleRecording() {
+    if (audioProcessor.isRecording()) {
+        audioProcessor.stopRecording();
+        updateRecordingControls();
+        return;
     }
 
-    spectrogramImagePos += 1;
+    auto result = audioProcessor.startRecording();
+    updateRecordingControls();
 
-    if (spectrogramImagePos >= spectrogramWidth) {
-        spectrogramImagePos = 0;
-    }
-}
-
-void SpectrogramVSTAudioProcessorEditor::timerCallback()
-{
-    if (audioProcessor.apvts.getRawParameterValue("Reassignment Enabled")->load()) {
-        updateSpectrogramReassigned();
-    }
-    else {
-        updateSpectrogram();
+    if (result.failed()) {
+        recordingLabel.setText(result.getErrorMessage(), juce::dontSendNotification);
     }
-
-    repaint();
 }
 
-void SpectrogramVSTAudioProcessorEditor::drawSpectrogram(juce::Graphics& g, juce::Rectangle<int> area)
-{
-    auto w = area.getWidth();
-    auto h = area.getHeight();
+void SpectrogramVSTAudioProcessorEditor::updateRecordingControls() {
+    bool isRecording = audioProcessor.isRecording();
+    recordButton.setButtonText(isRecording ? "Stop Recording" : "Record");
+    recordButton.setToggleState(isRecording, juce::dontSendNotification);
 
-    if (spectrogramImage.isNull())
-    {
-        spectrogramImage = juce::Image(juce::Image::RGB, w, h, true);
-        spectrogramImagePos = 0;
+    if (isRecording) {
+        recordingLabel.setText(audioProcessor.getRecordingFile().getFileName(), juce::dontSendNotification);
+    }
+    else if (audioProcessor.getRecordingFile() != juce::File()) {
+        recordingLabel.setText("Saved " + audioProcessor.getRecordingFile().getFileName(), juce::dontSendNotification);
     }
-
-    g.drawImage(spectrogramImage, area.toFloat());
-}
-
-void SpectrogramVSTAudioProcessorEditor::initializeColorMap() {
-    infernoGradient.addColour(0.0, juce::Colour::fromRGB(0, 0, 4));
-    infernoGradient.addColour(0.14, juce::Colour::fromRGB(40, 11, 84));
-    infernoGradient.addColour(0.29, juce::Colour::fromRGB(101, 21, 110));
-    infernoGradient.addColour(0.43, juce::Colour::fromRGB(159, 42, 99));
-    infernoGradient.addColour(0.57, juce::Colour::fromRGB(212, 72, 66));
-    infernoGradient.addColour(0.71, juce::Colour::fromRGB(245, 125, 21));
-    infernoGradient.addColour(0.88, juce::Colour::fromRGB(250, 193, 39));
-    infernoGradient.addColour(1.f, juce::Colour::fromRGB(252, 255, 164));
 }
 
-
 void SpectrogramVSTAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds();
-    auto slidersArea = bounds.removeFromRight(200).removeFromLeft(175).removeFromTop(500);
+    spectrogramComponent.setBounds(bounds.removeFromLeft(512));
+    auto slidersArea = bounds.removeFromRight(200).removeFromLeft(175);
 
     noiseFloorSlider.setBounds(slidersArea.removeFromTop(50));
     despecklingCutoffSlider.setBounds(slidersArea.removeFromTop(50));
-    fftSizeComboBox.setBounds(slidersArea.removeFromTop(50).removeFromBottom(30));
-    useReassignmentComboBox.setBounds(slidersArea.removeFromTop(50).removeFromBottom(30));
+    fftSizeComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    fftSizeUnitComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    hopSizeComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    windowComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    useReassignmentComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    trackPartialsComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    analysisPriorityComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    backlogPolicyComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    channelModeComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    streamDisplayComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    colourMapComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    frequencyScaleComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    scrollSpeedComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    maxFrequencyComboBox.setBounds(slidersArea.removeFromTop(32).removeFromBottom(30));
+    recordButton.setBounds(slidersArea.removeFromTop(30));
+    recordingLabel.setBounds(slidersArea.removeFromTop(20));
 }
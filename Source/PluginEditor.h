@@ -9,6 +9,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "SpectrogramComponent.h"
 //==============================================================================
 /**
 */
@@ -23,38 +24,72 @@ public:
     void resized() override;
 
 private:
-    float sampleRate;
-    float refreshRateHz;
-    int spectrogramImagePos;
-    int scrollSpeed;
-    juce::Image spectrogramImage;
     SpectrogramVSTAudioProcessor& audioProcessor;
-    juce::ColourGradient infernoGradient;
+    SpectrogramComponent spectrogramComponent;
 
     juce::Slider noiseFloorSlider;
     juce::Slider despecklingCutoffSlider;
     juce::ComboBox fftSizeComboBox;
+    juce::ComboBox fftSizeUnitComboBox;
+    juce::ComboBox hopSizeComboBox;
+    juce::ComboBox windowComboBox;
+    juce::ComboBox analysisPriorityComboBox;
+    juce::ComboBox backlogPolicyComboBox;
+    juce::ComboBox channelModeComboBox;
+    juce::ComboBox streamDisplayComboBox;
+    juce::ComboBox colourMapComboBox;
+    juce::ComboBox frequencyScaleComboBox;
+    juce::ComboBox scrollSpeedComboBox;
+    juce::ComboBox maxFrequencyComboBox;
     juce::ComboBox useReassignmentComboBox; // TODO: This should not be a combo box.
+    juce::ComboBox trackPartialsComboBox;
+    juce::TextButton recordButton;
+    juce::Label recordingLabel;
 
     juce::AudioProcessorValueTreeState::SliderAttachment noiseFloorSliderAttachment;
     juce::AudioProcessorValueTreeState::SliderAttachment despecklingCutoffSliderAttachment;
     juce::AudioProcessorValueTreeState::ComboBoxAttachment fftSizeComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment fftSizeUnitComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment hopSizeComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment windowComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment analysisPriorityComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment backlogPolicyComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment channelModeComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment streamDisplayComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment colourMapComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment frequencyScaleComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment scrollSpeedComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment maxFrequencyComboBoxAttachment;
     juce::AudioProcessorValueTreeState::ComboBoxAttachment useReassignmentComboBoxAttachment;
+    juce::AudioProcessorValueTreeState::ComboBoxAttachment trackPartialsComboBoxAttachment;
 
     juce::Label noiseFloorSliderLabel;
     juce::Label despecklingCutoffLabel;
     juce::Label fftSizeComboBoxLabel;
+    juce::Label fftSizeUnitComboBoxLabel;
+    juce::Label hopSizeComboBoxLabel;
+    juce::Label windowComboBoxLabel;
+    juce::Label analysisPriorityComboBoxLabel;
+    juce::Label backlogPolicyComboBoxLabel;
+    juce::Label channelModeComboBoxLabel;
+    juce::Label streamDisplayComboBoxLabel;
+    juce::Label colourMapComboBoxLabel;
+    juce::Label frequencyScaleComboBoxLabel;
+    juce::Label scrollSpeedComboBoxLabel;
+    juce::Label maxFrequencyComboBoxLabel;
     juce::Label useReassignmentComboBoxLabel;
+    juce::Label trackPartialsComboBoxLabel;
 
-    void updateSpectrogram();
-
-    void updateSpectrogramReassigned();
+    // Whether the FFT sizes are named as durations.
+    bool showsFFTDurations;
 
     void timerCallback();
 
-    void drawSpectrogram(juce::Graphics& g, juce::Rectangle<int> area);
+    void updateFFTSizeNames();
+
+    void toggleRecording();
 
-    void initializeColorMap();
+    void updateRecordingControls();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrogramVSTAudioProcessorEditor)
 };
@@ -8,6 +8,9 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "AllocationGuard.h"
+#include "ColourMap.h"
+#include "FrequencyAxis.h"
 
 //==============================================================================
 SpectrogramVSTAudioProcessor::SpectrogramVSTAudioProcessor()
@@ -21,16 +24,37 @@ SpectrogramVSTAudioProcessor::SpectrogramVSTAudioProcessor()
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        ),
-        fftDataGenerator(2048, 48000)
+        analysisWorker(analysisConfigurations, recorder)
 #endif
 {
     for (int i = 10; i <= 13; i++) {
         fftChoiceOrders.push_back(i);
     }
+
+    for (int divisor = 4; divisor <= 16; divisor *= 2) {
+        hopChoiceDivisors.push_back(divisor);
+    }
+
+    for (int samples = 64; samples >= 16; samples /= 2) {
+        hopChoiceSamples.push_back(samples);
+    }
+
+    for (auto* parameter : getParameters()) {
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter)) {
+            apvts.addParameterListener(withID->paramID, this);
+        }
+    }
+
+    updateParameters();
 }
 
 SpectrogramVSTAudioProcessor::~SpectrogramVSTAudioProcessor()
 {
+    for (auto* parameter : getParameters()) {
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter)) {
+            apvts.removeParameterListener(withID->paramID, this);
+        }
+    }
 }
 
 //==============================================================================
@@ -108,13 +132,17 @@ void SpectrogramVSTAudioProcessor::prepareToPlay (double sampleRate, int samples
     osc.setFrequency(40);
 
     gain.setGainLinear(0.1f);
+
+    // Also picks the FFT size for the new rate, when it's a duration.
     updateParameters();
+    analysisWorker.prepare(sampleRate, samplesPerBlock, getTotalNumInputChannels());
 }
 
 void SpectrogramVSTAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    analysisWorker.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -124,12 +152,10 @@ bool SpectrogramVSTAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Anything from mono up to 7.1, every channel gets analysed.
+    auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (numChannels < 1 || numChannels > AnalysisWorker::maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -153,29 +179,9 @@ void SpectrogramVSTAudioProcessor::processBlock (juce::AudioBuffer<float>& buffe
         gain.process(stereoContext);
     */
 
-    pushIntoFFTBuffer(buffer);
-    updateParameters(); // TODO: This is pretty expensive and we don't have to do this every time!
-    fftDataGenerator.reassignedSpectrogram(fftBuffer, times, frequencies, magnitudes, standardFFTResult);
-}
-
-void SpectrogramVSTAudioProcessor::pushIntoFFTBuffer(juce::AudioBuffer<float>& buffer) {
-    int size = buffer.getNumSamples();
-
-    for (int channel = 0; channel < 2; channel++) {
-        // Move the existing data back by the size of the new buffer
-        juce::FloatVectorOperations::copy( 
-            fftBuffer.getWritePointer(channel, 0), // destination
-            fftBuffer.getReadPointer(channel, size), // source
-            fftBuffer.getNumSamples() - size // num values
-        );
-
-        // Put the new data into the buffer
-        juce::FloatVectorOperations::copy(
-            fftBuffer.getWritePointer(channel, fftBuffer.getNumSamples() - size), // destination
-            buffer.getReadPointer(channel, 0), // source
-            size
-        );
-    }
+    // All of the analysis happens on the worker thread, this just hands it the samples.
+    AllocationGuard noAllocations;
+    analysisWorker.pushSamples(buffer);
 }
 
 
@@ -211,18 +217,115 @@ void SpectrogramVSTAudioProcessor::setStateInformation (const void* data, int si
     }
 }
 
+// Called whenever a parameter changes, from whichever thread changed it. It only reads the parameters and
+// forwards them to the worker, which picks the matching prebuilt configuration before its next chunk.
 void SpectrogramVSTAudioProcessor::updateParameters() {
     noiseFloorDb = apvts.getRawParameterValue("Noise Floor")->load();
     despecklingCutoff = apvts.getRawParameterValue("Despeckling Cutoff")->load();
 
+    // The last choice is multi-resolution, whose frames have the largest size's bins at the smallest size's hop.
     int fftIndex = apvts.getRawParameterValue("FFT Size")->load();
-    fftSize = 1 << fftChoiceOrders[fftIndex];
+    bool multiResolution = fftIndex >= (int)fftChoiceOrders.size();
+    int fftOrder = multiResolution ? fftChoiceOrders.back() : fftChoiceOrders[fftIndex];
+
+    // As a duration, the size nearest to that many milliseconds at the session's rate, as far as the sizes go.
+    // That keeps the time and frequency resolution the same whatever the rate.
+    bool fftSizeAsDuration = apvts.getRawParameterValue("FFT Size Unit")->load() == 1;
+
+    if (fftSizeAsDuration && !multiResolution && getSampleRate() > 0) {
+        int orderChange = juce::roundToInt(std::log2(getSampleRate() / fftDurationReferenceRate));
+        fftOrder = juce::jlimit(AnalysisConfigurationCache::minFFTOrder, AnalysisConfigurationCache::maxFFTOrder, fftOrder + orderChange);
+    }
+
+    int newFFTSize = 1 << fftOrder;
+    fftSize = newFFTSize;
+
+    // After the divisors come hops of a fixed number of samples, which at 16 use the sliding DFT.
+    int hopIndex = apvts.getRawParameterValue("Hop Size")->load();
+    int hopReference = multiResolution ? 1 << fftChoiceOrders.front() : newFFTSize;
+    int numDivisors = (int)hopChoiceDivisors.size();
+    hopSize = hopIndex < numDivisors ? hopReference / hopChoiceDivisors[hopIndex] : hopChoiceSamples[hopIndex - numDivisors];
+
+    window = (AnalysisConfiguration::Window)(int)apvts.getRawParameterValue("Window")->load();
+
+    analysisWorker.setParameters(fftOrder, window.load(), hopSize.load(), despecklingCutoff.load(), noiseFloorDb.load(), multiResolution);
+
+    int priorityIndex = apvts.getRawParameterValue("Analysis Priority")->load();
+    juce::Thread::Priority priorities[] = { juce::Thread::Priority::low, juce::Thread::Priority::normal, juce::Thread::Priority::high };
+    analysisWorker.setAnalysisPriority(priorities[priorityIndex]);
+
+    int backlogPolicyIndex = apvts.getRawParameterValue("Backlog Policy")->load();
+    analysisWorker.setBacklogPolicy(backlogPolicyIndex == 0 ? AnalysisWorker::BacklogPolicy::dropOldest : AnalysisWorker::BacklogPolicy::coalesce);
+
+    int channelModeIndex = apvts.getRawParameterValue("Channel Mode")->load();
+    analysisWorker.setChannelMode(channelModeIndex == 0 ? AnalysisWorker::ChannelMode::perChannel : AnalysisWorker::ChannelMode::midSide);
+
+    analysisWorker.setPartialTracking(apvts.getRawParameterValue("Track Partials")->load() == 1);
+}
+
+int SpectrogramVSTAudioProcessor::getNumAnalysisStreams() const {
+    return analysisWorker.getNumStreams();
+}
+
+SpectralFrameQueue& SpectrogramVSTAudioProcessor::getFrameQueue(int stream) {
+    return analysisWorker.getFrameQueue(stream);
+}
+
+AnalysisWorker::ChannelMode SpectrogramVSTAudioProcessor::getAnalysisChannelMode() const {
+    return analysisWorker.getChannelMode();
+}
+
+void SpectrogramVSTAudioProcessor::setDisplayAxis(FrequencyAxis::Scale scale, float minFrequency, float maxFrequency, int numRows) {
+    analysisWorker.setDisplayAxis(scale, minFrequency, maxFrequency, numRows);
+}
+
+juce::Result SpectrogramVSTAudioProcessor::startRecording() {
+    auto directory = getRecordingsDirectory();
+    auto result = directory.createDirectory();
+
+    if (result.failed()) {
+        return result;
+    }
+
+    SpectralRecorder::Settings settings;
+    settings.sampleRate = getSampleRate() > 0 ? getSampleRate() : 48000;
+    settings.fftSize = fftSize.load();
+    settings.hopSize = hopSize.load();
+    settings.window = (RecordingFormat::Window)window.load();
+    settings.numStreams = getNumAnalysisStreams();
+    settings.floorDb = noiseFloorDb.load(); // what's visible is what gets recorded
+
+    auto name = "Spectrogram " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S");
+    return recorder.start(directory.getNonexistentChildFile(name, RecordingFormat::fileExtension, false), settings);
+}
+
+void SpectrogramVSTAudioProcessor::stopRecording() {
+    recorder.stop();
+}
+
+bool SpectrogramVSTAudioProcessor::isRecording() const {
+    return recorder.isRecording();
+}
+
+juce::File SpectrogramVSTAudioProcessor::getRecordingFile() const {
+    return recorder.getFile();
+}
+
+juce::File SpectrogramVSTAudioProcessor::getRecordingsDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("SpectrogramVST Recordings");
+}
 
-    if (fftBuffer.getNumSamples() != fftSize) {
-        fftBuffer.setSize(2, fftSize);
+juce::String SpectrogramVSTAudioProcessor::getAnalysisStreamName(int stream) const {
+    if (getAnalysisChannelMode() == AnalysisWorker::ChannelMode::midSide) {
+        return stream == 0 ? "M" : "S";
     }
 
-    fftDataGenerator.updateParameters(fftSize, despecklingCutoff);
+    auto layout = getChannelLayoutOfBus(true, 0);
+    return juce::AudioChannelSet::getAbbreviatedChannelTypeName(layout.getTypeOfChannel(stream));
+}
+
+void SpectrogramVSTAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue) {
+    updateParameters();
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout 
@@ -257,6 +360,8 @@ SpectrogramVSTAudioProcessor::createParameterLayout() {
         fftChoices.add(str);
     }
 
+    fftChoices.add("Multi-resolution");
+
     layout.add(
         std::make_unique<juce::AudioParameterChoice>(
             "FFT Size",
@@ -266,6 +371,158 @@ SpectrogramVSTAudioProcessor::createParameterLayout() {
         )
     );
 
+    juce::StringArray fftSizeUnitChoices;
+    fftSizeUnitChoices.add("Samples");
+    fftSizeUnitChoices.add("Duration");
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "FFT Size Unit",
+            "FFT Size Unit",
+            fftSizeUnitChoices,
+            0
+        )
+    );
+
+    juce::StringArray hopChoices;
+
+    for (int divisor = 4; divisor <= 16; divisor *= 2) {
+        juce::String str;
+        str << "FFT Size / " << divisor;
+        hopChoices.add(str);
+    }
+
+    for (int samples = 64; samples >= 16; samples /= 2) {
+        juce::String str;
+        str << samples << " samples";
+        hopChoices.add(str);
+    }
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Hop Size",
+            "Hop Size",
+            hopChoices,
+            0
+        )
+    );
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Window",
+            "Window",
+            AnalysisConfiguration::getWindowNames(),
+            (int)AnalysisConfiguration::Window::blackmanHarris
+        )
+    );
+
+    juce::StringArray priorityChoices;
+    priorityChoices.add("Low");
+    priorityChoices.add("Normal");
+    priorityChoices.add("High");
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Analysis Priority",
+            "Analysis Priority",
+            priorityChoices,
+            1
+        )
+    );
+
+    juce::StringArray backlogPolicyChoices;
+    backlogPolicyChoices.add("Drop Oldest");
+    backlogPolicyChoices.add("Coalesce");
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Backlog Policy",
+            "Backlog Policy",
+            backlogPolicyChoices,
+            1
+        )
+    );
+
+    juce::StringArray channelModeChoices;
+    channelModeChoices.add("Per Channel");
+    channelModeChoices.add("Mid / Side");
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Channel Mode",
+            "Channel Mode",
+            channelModeChoices,
+            0
+        )
+    );
+
+    juce::StringArray streamDisplayChoices;
+    streamDisplayChoices.add("Overlay");
+    streamDisplayChoices.add("Side by Side");
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Stream Display",
+            "Stream Display",
+            streamDisplayChoices,
+            1
+        )
+    );
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Colour Map",
+            "Colour Map",
+            ColourMap::getNames(),
+            (int)ColourMap::Type::inferno
+        )
+    );
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Frequency Scale",
+            "Frequency Scale",
+            FrequencyAxis::getScaleNames(),
+            (int)FrequencyAxis::Scale::log
+        )
+    );
+
+    // In the order of SpectrogramComponent::scrollSpeeds.
+    juce::StringArray scrollSpeedChoices;
+    scrollSpeedChoices.add("60 px/s");
+    scrollSpeedChoices.add("120 px/s");
+    scrollSpeedChoices.add("240 px/s");
+    scrollSpeedChoices.add("480 px/s");
+    scrollSpeedChoices.add("960 px/s");
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Scroll Speed",
+            "Scroll Speed",
+            scrollSpeedChoices,
+            2
+        )
+    );
+
+    // In the order of SpectrogramComponent::maxFrequencies.
+    juce::StringArray maxFrequencyChoices;
+    maxFrequencyChoices.add("Full");
+    maxFrequencyChoices.add("8 kHz");
+    maxFrequencyChoices.add("4 kHz");
+    maxFrequencyChoices.add("2 kHz");
+    maxFrequencyChoices.add("1 kHz");
+    maxFrequencyChoices.add("500 Hz");
+    maxFrequencyChoices.add("250 Hz");
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Max Frequency",
+            "Max Frequency",
+            maxFrequencyChoices,
+            0
+        )
+    );
+
     juce::StringArray useReassignmentChoices;
     useReassignmentChoices.add("No");
     useReassignmentChoices.add("Yes");
@@ -279,6 +536,19 @@ SpectrogramVSTAudioProcessor::createParameterLayout() {
         )
     );
 
+    juce::StringArray trackPartialsChoices;
+    trackPartialsChoices.add("No");
+    trackPartialsChoices.add("Yes");
+
+    layout.add(
+        std::make_unique<juce::AudioParameterChoice>(
+            "Track Partials",
+            "Track Partials",
+            trackPartialsChoices,
+            0
+        )
+    );
+
     return layout;
 }
 
@@ -9,16 +9,16 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "FFTDataGenerator.h"
+#include "AnalysisWorker.h"
+#include "SpectralFrameQueue.h"
 
 //==============================================================================
 /**
 */
-class SpectrogramVSTAudioProcessor  : public juce::AudioProcessor
+class SpectrogramVSTAudioProcessor  : public juce::AudioProcessor,
+                                      private juce::AudioProcessorValueTreeState::Listener
 {
 public:
-    FFTDataGenerator fftDataGenerator;
-
     SpectrogramVSTAudioProcessor();
     ~SpectrogramVSTAudioProcessor() override;
 
@@ -40,7 +40,6 @@ public:
     bool producesMidi() const override;
     bool isMidiEffect() const override;
     double getTailLengthSeconds() const override;
-    void SpectrogramVSTAudioProcessor::pushIntoFFTBuffer(juce::AudioBuffer<float>& buffer);
 
     int getNumPrograms() override;
     int getCurrentProgram() override;
@@ -53,23 +52,46 @@ public:
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    std::vector<float> times;
-    std::vector<float> frequencies;
-    std::vector<float> magnitudes;
-    std::vector<float> standardFFTResult;
-
-    float noiseFloorDb = -48.f;
-    float despecklingCutoff = 1.f;
-    float fftSize = 1024.f;
+    // Analysed frames, one queue per stream, written by the analysis worker and drained by the editor.
+    int getNumAnalysisStreams() const;
+    SpectralFrameQueue& getFrameQueue(int stream);
+    juce::String getAnalysisStreamName(int stream) const;
+    AnalysisWorker::ChannelMode getAnalysisChannelMode() const;
+
+    // Editor side. Where the reassigned points should be accumulated, see AnalysisWorker::setDisplayAxis().
+    void setDisplayAxis(FrequencyAxis::Scale scale, float minFrequency, float maxFrequency, int numRows);
+
+    // Message thread. Records the analysed frames of every stream to a new file in getRecordingsDirectory().
+    juce::Result startRecording();
+    void stopRecording();
+    bool isRecording() const;
+    juce::File getRecordingFile() const;
+    static juce::File getRecordingsDirectory();
+
+    // With "FFT Size Unit" on duration, the FFT sizes stand for how long they are at this rate.
+    static constexpr double fftDurationReferenceRate = 48000.0;
+
+    // Written by updateParameters(), which hosts call on the audio thread under automation, and read by the
+    // editor and startRecording() on the message thread.
+    std::atomic<float> noiseFloorDb { -48.f };
+    std::atomic<float> despecklingCutoff { 1.f };
+    std::atomic<int> fftSize { 1024 };
+    std::atomic<int> hopSize { 256 };
+    std::atomic<AnalysisConfiguration::Window> window { AnalysisConfiguration::Window::blackmanHarris };
 
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout() };
 
 private:
-    juce::AudioBuffer<float> fftBuffer;
+    AnalysisConfigurationCache analysisConfigurations;
+    SpectralRecorder recorder;
+    AnalysisWorker analysisWorker;
     juce::dsp::Oscillator<float> osc;
     juce::dsp::Gain<float> gain;
     std::vector<int> fftChoiceOrders;
-    void SpectrogramVSTAudioProcessor::updateParameters();
+    std::vector<int> hopChoiceDivisors;
+    std::vector<int> hopChoiceSamples;
+    void updateParameters();
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrogramVSTAudioProcessor)
 };
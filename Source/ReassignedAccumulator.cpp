@@ -0,0 +1,121 @@
+#include "ReassignedAccumulator.h"
+#include "ReassignmentKernel.h"
+
+static constexpr float log2Of10Over10 = 0.332192809489f;
+
+ReassignedAccumulator::ReassignedAccumulator(int _sampleRate):
+    sampleRate((float)_sampleRate),
+    numRows(0),
+    hopSize(512),
+    reach(0),
+    currentColumn(0)
+{
+}
+
+void ReassignedAccumulator::prepare(FrequencyAxis::Scale scale, float minFrequency, float maxFrequency, int _numRows, int fftSize, int _hopSize) {
+    _numRows = juce::jmin(_numRows, SpectralFrame::maxAccumulatedRows);
+
+    if (_numRows < 2) {
+        numRows = 0;
+        return;
+    }
+
+    bool axisChanged = frequencyAxis.update(scale, minFrequency, maxFrequency, _numRows, fftSize, sampleRate);
+
+    if (!axisChanged && _numRows == numRows && _hopSize == hopSize) {
+        return;
+    }
+
+    numRows = _numRows;
+    hopSize = _hopSize;
+    reach = juce::jlimit(1, maxColumns / 2 - 1, (fftSize / 2 + hopSize - 1) / hopSize);
+    grid.assign((size_t)(maxColumns * numRows), 0.f);
+    currentColumn = 0;
+}
+
+void ReassignedAccumulator::reset() {
+    std::fill(grid.begin(), grid.end(), 0.f);
+    currentColumn = 0;
+}
+
+void ReassignedAccumulator::setSampleRate(float _sampleRate) {
+    sampleRate = _sampleRate;
+}
+
+bool ReassignedAccumulator::isActive() const {
+    return numRows > 0;
+}
+
+void ReassignedAccumulator::process(SpectralFrame& frame) {
+    if (!isActive()) {
+        frame.numAccumulatedRows = 0;
+        return;
+    }
+
+    float columnsPerSecond = sampleRate / hopSize;
+
+    for (int i = 0; i < frame.numPoints; i++) {
+        // Written so NaN fails too.
+        float offset = frame.times[i] * columnsPerSecond;
+
+        if (!(std::abs(offset) <= (float)reach)) {
+            continue;
+        }
+
+        float row = frequencyAxis.getRowPosition(frame.frequencies[i]);
+
+        if (row <= -1.f) {
+            continue;
+        }
+
+        // The dB came from 4 |X|^2, so this is back to that.
+        float power = std::exp2(frame.magnitudes[i] * log2Of10Over10);
+
+        // Cell centres are half a cell in, so a point in the middle of a cell lands only on that cell.
+        splat(offset, row - 0.5f, power);
+    }
+
+    // Nothing from this frame on can reach back this far.
+    auto* finished = getColumn(currentColumn - reach);
+
+    for (int row = 0; row < numRows; row++) {
+        frame.accumulated[row] = ReassignmentKernel::fastDecibels(finished[row] * 0.25f);
+    }
+
+    frame.numAccumulatedRows = numRows;
+    frame.accumulatedSamplePosition = frame.samplePosition - (juce::int64)(frame.fftSize / 2 + reach * hopSize) * frame.decimation;
+    std::fill(finished, finished + numRows, 0.f);
+
+    // The ring index only ever wraps, the masking in getColumn() handles the rest.
+    currentColumn = (currentColumn + 1) & (maxColumns - 1);
+}
+
+int ReassignedAccumulator::getLatency() const {
+    return reach;
+}
+
+float* ReassignedAccumulator::getColumn(int column) {
+    return grid.data() + (size_t)((column & (maxColumns - 1)) * numRows);
+}
+
+void ReassignedAccumulator::splat(float column, float row, float power) {
+    float firstColumn = std::floor(column);
+    float firstRow = std::floor(row);
+    float columnWeight = column - firstColumn;
+    float rowWeight = row - firstRow;
+    int c = currentColumn + (int)firstColumn;
+    int r = (int)firstRow;
+
+    float* left = getColumn(c);
+    float* right = getColumn(c + 1);
+
+    if (r >= 0 && r < numRows) {
+        left[r] += power * (1.f - columnWeight) * (1.f - rowWeight);
+        right[r] += power * columnWeight * (1.f - rowWeight);
+    }
+
+    if (r + 1 >= 0 && r + 1 < numRows) {
+        left[r + 1] += power * (1.f - columnWeight) * rowWeight;
+        right[r + 1] += power * columnWeight * rowWeight;
+    }
+}
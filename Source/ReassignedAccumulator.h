@@ -0,0 +1,56 @@
+#pragma once
+#include <JuceHeader.h>
+#include "FrequencyAxis.h"
+#include "SpectralFrame.h"
+
+// Sums the energy of reassigned points into a small time-frequency grid on the display's rows, so the editor
+// gets one finished column per frame instead of a list of points to plot.
+// Each point is split bilinearly between the four cells around its exact (time, row) position, and points from
+// overlapping frames add up. A column is finished once no later frame can reach it any more, which is
+// getLatency() frames after the one that started it.
+class ReassignedAccumulator
+{
+public:
+    // Columns in the ring. A point can land up to fftSize / 2 samples either side of its frame, and with the
+    // smallest hop (fftSize / 16) that's 8 columns each way. Multi-resolution frames are 8192 wide at a hop
+    // of 64, which is 64 each way.
+    static constexpr int maxColumns = 256;
+
+    ReassignedAccumulator(int _sampleRate);
+
+    // Not real-time safe: rebuilds the frequency axis and the grid if anything changed, clearing it.
+    // With numRows below 2 (e.g. while no editor is open) it does nothing at all.
+    void prepare(FrequencyAxis::Scale scale, float minFrequency, float maxFrequency, int _numRows, int fftSize, int _hopSize);
+
+    void reset();
+
+    // The rate of the frames' samples, when that isn't the one it was made with (see Decimator). Takes effect at
+    // the next prepare().
+    void setSampleRate(float _sampleRate);
+
+    bool isActive() const;
+
+    // Adds the frame's points, then writes the column that can't change any more into the frame's accumulated
+    // column, and starts a new one.
+    void process(SpectralFrame& frame);
+
+    // How many frames the accumulated column lags behind the frame it's sent with.
+    int getLatency() const;
+
+private:
+    FrequencyAxis frequencyAxis;
+    float sampleRate;
+    int numRows;
+    int hopSize;
+    int reach;
+
+    // Power, maxColumns columns of numRows rows, row 0 at the bottom. The current frame's column is currentColumn.
+    std::vector<float> grid;
+    int currentColumn;
+
+    float* getColumn(int column);
+
+    void splat(float column, float row, float power);
+
+    JUCE_DECLARE_NON_COPYABLE(ReassignedAccumulator)
+};
@@ -0,0 +1,233 @@
+#include "ReassignmentKernel.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+ #include <arm_neon.h>
+ #define REASSIGNMENT_KERNEL_USE_NEON 1
+#endif
+
+static constexpr float minusInfinityDb = -100.f;
+static constexpr float decibelsPerOctaveOfPower = 3.01029995664f; // 10 * log10(2)
+
+// log2(m) for m in [1, 2), via log2(m) = 2 / ln(2) * atanh((m - 1) / (m + 1)).
+// (m - 1) / (m + 1) is at most 1/3, so five terms of the series are plenty.
+template <typename Floats>
+static Floats log2OfMantissa(Floats mantissa) {
+    auto one = Floats::fill(1.f);
+    auto t = (mantissa - one) / (mantissa + one);
+    auto t2 = t * t;
+
+    return t * (Floats::fill(2.88539008178f)
+         + t2 * (Floats::fill(0.961796693926f)
+         + t2 * (Floats::fill(0.577078016356f)
+         + t2 * (Floats::fill(0.412198583111f)
+         + t2 * Floats::fill(0.320598897975f)))));
+}
+
+// Only valid for non-negative input. Zero and denormals come out far below -100 dB, which is all we need.
+template <typename Floats>
+static Floats fastLog2(Floats x) {
+    Floats exponent, mantissa;
+    Floats::split(x, exponent, mantissa);
+    return exponent + log2OfMantissa(mantissa);
+}
+
+//==============================================================================
+struct ScalarFloats
+{
+    static constexpr int size = 1;
+    using Mask = bool;
+
+    float value;
+
+    static ScalarFloats load(const float* source) { return { *source }; }
+    void store(float* destination) const { *destination = value; }
+    static ScalarFloats fill(float v) { return { v }; }
+    static ScalarFloats ramp(float start) { return { start }; }
+
+    friend ScalarFloats operator+(ScalarFloats a, ScalarFloats b) { return { a.value + b.value }; }
+    friend ScalarFloats operator-(ScalarFloats a, ScalarFloats b) { return { a.value - b.value }; }
+    friend ScalarFloats operator*(ScalarFloats a, ScalarFloats b) { return { a.value * b.value }; }
+    friend ScalarFloats operator/(ScalarFloats a, ScalarFloats b) { return { a.value / b.value }; }
+
+    static ScalarFloats max(ScalarFloats a, ScalarFloats b) { return { a.value > b.value ? a.value : b.value }; }
+    static ScalarFloats abs(ScalarFloats a) { return { std::abs(a.value) }; }
+    static Mask greaterThan(ScalarFloats a, ScalarFloats b) { return a.value > b.value; }
+    static ScalarFloats select(Mask mask, ScalarFloats ifTrue, ScalarFloats ifFalse) { return mask ? ifTrue : ifFalse; }
+
+    static void split(ScalarFloats x, ScalarFloats& exponent, ScalarFloats& mantissa) {
+        juce::uint32 bits;
+        std::memcpy(&bits, &x.value, sizeof(bits));
+        exponent.value = (float)((int)(bits >> 23) - 127);
+
+        bits = (bits & 0x007fffffu) | 0x3f800000u;
+        std::memcpy(&mantissa.value, &bits, sizeof(bits));
+    }
+};
+
+#if JUCE_USE_SSE_INTRINSICS
+struct VectorFloats
+{
+    static constexpr int size = 4;
+    using Mask = __m128;
+
+    __m128 value;
+
+    static VectorFloats load(const float* source) { return { _mm_loadu_ps(source) }; }
+    void store(float* destination) const { _mm_storeu_ps(destination, value); }
+    static VectorFloats fill(float v) { return { _mm_set1_ps(v) }; }
+    static VectorFloats ramp(float start) { return { _mm_setr_ps(start, start + 1.f, start + 2.f, start + 3.f) }; }
+
+    friend VectorFloats operator+(VectorFloats a, VectorFloats b) { return { _mm_add_ps(a.value, b.value) }; }
+    friend VectorFloats operator-(VectorFloats a, VectorFloats b) { return { _mm_sub_ps(a.value, b.value) }; }
+    friend VectorFloats operator*(VectorFloats a, VectorFloats b) { return { _mm_mul_ps(a.value, b.value) }; }
+    friend VectorFloats operator/(VectorFloats a, VectorFloats b) { return { _mm_div_ps(a.value, b.value) }; }
+
+    static VectorFloats max(VectorFloats a, VectorFloats b) { return { _mm_max_ps(a.value, b.value) }; }
+    static VectorFloats abs(VectorFloats a) { return { _mm_andnot_ps(_mm_set1_ps(-0.f), a.value) }; }
+    static Mask greaterThan(VectorFloats a, VectorFloats b) { return _mm_cmpgt_ps(a.value, b.value); }
+
+    static VectorFloats select(Mask mask, VectorFloats ifTrue, VectorFloats ifFalse) {
+        return { _mm_or_ps(_mm_and_ps(mask, ifTrue.value), _mm_andnot_ps(mask, ifFalse.value)) };
+    }
+
+    static void split(VectorFloats x, VectorFloats& exponent, VectorFloats& mantissa) {
+        __m128i bits = _mm_castps_si128(x.value);
+        exponent.value = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        mantissa.value = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+    }
+};
+#elif REASSIGNMENT_KERNEL_USE_NEON
+struct VectorFloats
+{
+    static constexpr int size = 4;
+    using Mask = uint32x4_t;
+
+    float32x4_t value;
+
+    static VectorFloats load(const float* source) { return { vld1q_f32(source) }; }
+    void store(float* destination) const { vst1q_f32(destination, value); }
+    static VectorFloats fill(float v) { return { vdupq_n_f32(v) }; }
+
+    static VectorFloats ramp(float start) {
+        float values[] = { start, start + 1.f, start + 2.f, start + 3.f };
+        return { vld1q_f32(values) };
+    }
+
+    friend VectorFloats operator+(VectorFloats a, VectorFloats b) { return { vaddq_f32(a.value, b.value) }; }
+    friend VectorFloats operator-(VectorFloats a, VectorFloats b) { return { vsubq_f32(a.value, b.value) }; }
+    friend VectorFloats operator*(VectorFloats a, VectorFloats b) { return { vmulq_f32(a.value, b.value) }; }
+    friend VectorFloats operator/(VectorFloats a, VectorFloats b) { return { vdivq_f32(a.value, b.value) }; }
+
+    static VectorFloats max(VectorFloats a, VectorFloats b) { return { vmaxq_f32(a.value, b.value) }; }
+    static VectorFloats abs(VectorFloats a) { return { vabsq_f32(a.value) }; }
+    static Mask greaterThan(VectorFloats a, VectorFloats b) { return vcgtq_f32(a.value, b.value); }
+    static VectorFloats select(Mask mask, VectorFloats ifTrue, VectorFloats ifFalse) { return { vbslq_f32(mask, ifTrue.value, ifFalse.value) }; }
+
+    static void split(VectorFloats x, VectorFloats& exponent, VectorFloats& mantissa) {
+        uint32x4_t bits = vreinterpretq_u32_f32(x.value);
+        exponent.value = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127)));
+        mantissa.value = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffffu)), vdupq_n_u32(0x3f800000u)));
+    }
+};
+#else
+using VectorFloats = ScalarFloats;
+#endif
+
+//==============================================================================
+// Processes bins [begin, end) in steps of Floats::size and returns the first bin it didn't get to.
+template <typename Floats>
+static int processBins(
+    const ReassignmentSpectra& spectra,
+    int begin,
+    int end,
+    float sampleRate,
+    float fftBinSize,
+    float despecklingCutoff,
+    float* times,
+    float* frequencies,
+    float* magnitudes,
+    float* standardFFTResult
+) {
+    const auto zero = Floats::fill(0.f);
+    const auto one = Floats::fill(1.f);
+    const auto smallestNormal = Floats::fill(std::numeric_limits<float>::min());
+    const auto binSize = Floats::fill(fftBinSize);
+    const auto secondsPerSample = Floats::fill(1.f / sampleRate);
+    const auto hzPerRadian = Floats::fill(sampleRate / juce::MathConstants<float>::twoPi);
+    const auto cutoff = Floats::fill(despecklingCutoff);
+    const auto floorDb = Floats::fill(minusInfinityDb);
+    const auto dbPerOctave = Floats::fill(decibelsPerOctaveOfPower);
+    const auto two = Floats::fill(2.f);
+
+    int bin = begin;
+
+    for (; bin + Floats::size <= end; bin += Floats::size) {
+        auto xr = Floats::load(spectra.real + bin);
+        auto xi = Floats::load(spectra.imag + bin);
+        auto dr = Floats::load(spectra.derivativeReal + bin);
+        auto di = Floats::load(spectra.derivativeImag + bin);
+        auto tr = Floats::load(spectra.timeWeightedReal + bin);
+        auto ti = Floats::load(spectra.timeWeightedImag + bin);
+        auto tdr = Floats::load(spectra.derivativeTimeWeightedReal + bin);
+        auto tdi = Floats::load(spectra.derivativeTimeWeightedImag + bin);
+
+        // Bins with no energy get an inverse of 0, which leaves them uncorrected instead of dividing by zero.
+        auto magnitudeSquared = xr * xr + xi * xi;
+        auto inverse = Floats::select(Floats::greaterThan(magnitudeSquared, zero), one / Floats::max(magnitudeSquared, smallestNormal), zero);
+
+        // real(X_Th / X), -imag(X_Dh / X), and real(X_T_Dh * conj(X) / |X|^2) - real(X_Th * X_Dh / |X|^2)
+        auto time = (tr * xr + ti * xi) * inverse * secondsPerSample;
+        auto frequencyCorrection = (dr * xi - di * xr) * inverse * hzPerRadian;
+        auto mixedPartialPhaseDerivative = (tdr * xr + tdi * xi - (tr * dr - ti * di)) * inverse;
+
+        // 20 * log10(2 * |X|) == 10 * log10(2) * (2 + log2(|X|^2))
+        auto standardDb = Floats::max(floorDb, (two + fastLog2(magnitudeSquared)) * dbPerOctave);
+        auto magnitudeDb = Floats::select(Floats::greaterThan(Floats::abs(mixedPartialPhaseDerivative), cutoff), floorDb, standardDb);
+
+        time.store(times + bin);
+        (Floats::ramp((float)bin) * binSize + frequencyCorrection).store(frequencies + bin);
+        magnitudeDb.store(magnitudes + bin);
+        standardDb.store(standardFFTResult + bin);
+    }
+
+    return bin;
+}
+
+void ReassignmentKernel::process(
+    const ReassignmentSpectra& spectra,
+    int numBins,
+    float sampleRate,
+    float fftBinSize,
+    float despecklingCutoff,
+    float* times,
+    float* frequencies,
+    float* magnitudes,
+    float* standardFFTResult
+) {
+    int bin = processBins<VectorFloats>(spectra, 0, numBins, sampleRate, fftBinSize, despecklingCutoff, times, frequencies, magnitudes, standardFFTResult);
+    processBins<ScalarFloats>(spectra, bin, numBins, sampleRate, fftBinSize, despecklingCutoff, times, frequencies, magnitudes, standardFFTResult);
+}
+
+int ReassignmentKernel::keepPoints(float* times, float* frequencies, float* magnitudes, int numPoints, float floorDb) {
+    // Never writes ahead of where it reads, so it can work in place.
+    int numKept = 0;
+    floorDb = juce::jmax(floorDb, minusInfinityDb);
+
+    for (int i = 0; i < numPoints; i++) {
+        if (magnitudes[i] > floorDb) {
+            times[numKept] = times[i];
+            frequencies[numKept] = frequencies[i];
+            magnitudes[numKept] = magnitudes[i];
+            numKept++;
+        }
+    }
+
+    return numKept;
+}
+
+float ReassignmentKernel::fastDecibels(float magnitudeSquared) {
+    auto x = ScalarFloats::fill(magnitudeSquared);
+    return juce::jmax(minusInfinityDb, (2.f + fastLog2(x).value) * decibelsPerOctaveOfPower);
+}
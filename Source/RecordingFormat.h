@@ -0,0 +1,124 @@
+#pragma once
+#include <JuceHeader.h>
+
+// On-disk layout of a spectrogram recording (.rspg).
+//
+//   FileHeader
+//   Chunk*         ChunkHeader, then numFrames frame records of FrameHeader + numPoints Points
+//   IndexEntry*    one per chunk        } only present if the recording was closed cleanly,
+//   Trailer                             } otherwise readers rebuild the index from the chunk headers
+//
+// Everything is little-endian and written as-is, which is what every platform we build for is anyway.
+// Points are quantised reassigned (time, frequency, magnitude) triples, and only points above the
+// recording's floor are stored, which is what keeps hours of data down to a sensible size.
+// Time and frequency are quantised at the rate the frame was analysed at (sampleRate / decimation), so a
+// decimated frame keeps the finer frequency steps it was decimated for.
+#if JUCE_BIG_ENDIAN
+ #error "Spectrogram recordings are written in the host's byte order, which is assumed to be little-endian"
+#endif
+
+namespace RecordingFormat
+{
+    constexpr juce::uint32 version = 2;
+    constexpr const char* fileExtension = ".rspg";
+
+    // The same values as AnalysisConfiguration::Window.
+    enum class Window : juce::uint32
+    {
+        blackmanHarris = 0,
+        hann,
+        gaussian,
+        kaiser
+    };
+
+    // Quantisation steps, in analysed samples.
+    constexpr float timeStepsPerSample = 8.f;     // time offsets from the frame centre, ±4096 samples
+    constexpr float frequencyStepsPerNyquist = 65535.f;
+    constexpr float magnitudeStepsPerDb = 100.f;   // ±327 dB
+
+    struct FileHeader
+    {
+        char magic[4] = { 'R', 'S', 'P', 'G' };
+        juce::uint32 version = RecordingFormat::version;
+        double sampleRate = 0;
+        juce::uint32 fftSize = 0;
+        juce::uint32 hopSize = 0;
+        Window window = Window::blackmanHarris;
+        juce::uint32 numStreams = 0;
+        float floorDb = 0;
+        juce::uint32 reserved[7] = {};
+    };
+
+    struct ChunkHeader
+    {
+        char magic[4] = { 'C', 'H', 'N', 'K' };
+        juce::uint32 numFrames = 0;
+        juce::uint32 payloadBytes = 0;
+        juce::uint32 reserved = 0;
+        juce::int64 firstSamplePosition = 0;
+        juce::int64 lastSamplePosition = 0;
+    };
+
+    struct FrameHeader
+    {
+        juce::int64 samplePosition = 0;
+        juce::uint8 stream = 0;
+        juce::uint8 fftOrder = 0;
+        juce::uint16 numPoints = 0;
+        juce::uint16 decimation = 1;   // input samples per analysed sample
+        juce::uint16 reserved = 0;
+    };
+
+    struct Point
+    {
+        juce::uint16 frequency;
+        juce::int16 time;
+        juce::int16 magnitude;
+    };
+
+    struct IndexEntry
+    {
+        juce::uint64 fileOffset = 0;
+        juce::int64 firstSamplePosition = 0;
+        juce::int64 lastSamplePosition = 0;
+        juce::uint32 numFrames = 0;
+        juce::uint32 reserved = 0;
+    };
+
+    struct Trailer
+    {
+        juce::uint64 indexOffset = 0;
+        juce::uint32 numEntries = 0;
+        char magic[4] = { 'R', 'I', 'D', 'X' };
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "FileHeader must not be padded");
+    static_assert(sizeof(ChunkHeader) == 32, "ChunkHeader must not be padded");
+    static_assert(sizeof(FrameHeader) == 16, "FrameHeader must not be padded");
+    static_assert(sizeof(Point) == 6, "Point must not be padded");
+    static_assert(sizeof(IndexEntry) == 32, "IndexEntry must not be padded");
+    static_assert(sizeof(Trailer) == 16, "Trailer must not be padded");
+
+    // analysedRate is the frame's sampleRate / decimation.
+    inline Point quantise(float timeSeconds, float frequency, float magnitudeDb, double analysedRate) {
+        auto nyquist = (float)analysedRate / 2;
+
+        Point point;
+        point.frequency = (juce::uint16)juce::jlimit(0, 65535, juce::roundToInt(frequency / nyquist * frequencyStepsPerNyquist));
+        point.time = (juce::int16)juce::jlimit(-32768, 32767, juce::roundToInt(timeSeconds * (float)analysedRate * timeStepsPerSample));
+        point.magnitude = (juce::int16)juce::jlimit(-32768, 32767, juce::roundToInt(magnitudeDb * magnitudeStepsPerDb));
+        return point;
+    }
+
+    inline float getTimeSeconds(const Point& point, double analysedRate) {
+        return point.time / (timeStepsPerSample * (float)analysedRate);
+    }
+
+    inline float getFrequency(const Point& point, double analysedRate) {
+        return point.frequency / frequencyStepsPerNyquist * (float)analysedRate / 2;
+    }
+
+    inline float getMagnitudeDb(const Point& point) {
+        return point.magnitude / magnitudeStepsPerDb;
+    }
+}
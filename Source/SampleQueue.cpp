@@ -0,0 +1,74 @@
+#include "SampleQueue.h"
+
+SampleQueue::SampleQueue():
+    fifo(1),
+    numOverflowedSamples(0)
+{
+}
+
+void SampleQueue::prepare(int numChannels, int capacity) {
+    // AbstractFifo always keeps one slot free.
+    fifo.setTotalSize(capacity + 1);
+    fifo.reset();
+    buffer.setSize(numChannels, capacity + 1);
+    buffer.clear();
+    numOverflowedSamples = 0;
+}
+
+void SampleQueue::push(const juce::AudioBuffer<float>& source) {
+    int numSamples = source.getNumSamples();
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    int numChannels = juce::jmin(buffer.getNumChannels(), source.getNumChannels());
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        if (size1 > 0) {
+            buffer.copyFrom(channel, start1, source, channel, 0, size1);
+        }
+
+        if (size2 > 0) {
+            buffer.copyFrom(channel, start2, source, channel, size1, size2);
+        }
+    }
+
+    fifo.finishedWrite(size1 + size2);
+
+    if (size1 + size2 < numSamples) {
+        numOverflowedSamples += numSamples - (size1 + size2);
+    }
+}
+
+int SampleQueue::read(juce::AudioBuffer<float>& destination, int numSamples) {
+    numSamples = juce::jmin(numSamples, destination.getNumSamples());
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+    int numChannels = juce::jmin(buffer.getNumChannels(), destination.getNumChannels());
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        if (size1 > 0) {
+            destination.copyFrom(channel, 0, buffer, channel, start1, size1);
+        }
+
+        if (size2 > 0) {
+            destination.copyFrom(channel, size1, buffer, channel, start2, size2);
+        }
+    }
+
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+void SampleQueue::discard(int numSamples) {
+    fifo.finishedRead(juce::jmin(numSamples, fifo.getNumReady()));
+}
+
+int SampleQueue::getNumReady() const {
+    return fifo.getNumReady();
+}
+
+juce::int64 SampleQueue::getNumOverflowedSamples() const {
+    return numOverflowedSamples.load();
+}
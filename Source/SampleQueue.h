@@ -0,0 +1,30 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Wait-free single-producer / single-consumer queue of multichannel audio.
+// The audio thread pushes whole blocks, the analysis thread reads them back in whatever chunk size suits it.
+class SampleQueue
+{
+public:
+    SampleQueue();
+
+    // Not real-time safe. Neither side may be using the queue while it is being prepared.
+    void prepare(int numChannels, int capacity);
+
+    // Producer side. Writes as much as fits and counts the rest as overflowed.
+    void push(const juce::AudioBuffer<float>& source);
+
+    // Consumer side. Returns how many samples were copied to the start of destination.
+    int read(juce::AudioBuffer<float>& destination, int numSamples);
+    void discard(int numSamples);
+
+    int getNumReady() const;
+    juce::int64 getNumOverflowedSamples() const;
+
+private:
+    juce::AbstractFifo fifo;
+    juce::AudioBuffer<float> buffer;
+    std::atomic<juce::int64> numOverflowedSamples;
+
+    JUCE_DECLARE_NON_COPYABLE(SampleQueue)
+};
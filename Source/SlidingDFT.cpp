@@ -0,0 +1,237 @@
+#include "SlidingDFT.h"
+
+static constexpr int maxFFTSize = SpectralFrame::maxFFTSize;
+
+SlidingDFT::SlidingDFT(int _sampleRate):
+    sampleRate((float)_sampleRate),
+    configuration(nullptr),
+    fftSize(0),
+    despecklingCutoff(2.f),
+    numTerms(0),
+    history(maxFFTSize, 0.f),
+    historyPosition(0),
+    samplesSinceResync(0),
+    plainReal(paddedBins, 0.f),
+    plainImag(paddedBins, 0.f),
+    timedReal(paddedBins, 0.f),
+    timedImag(paddedBins, 0.f),
+    rotationReal(paddedBins, 0.f),
+    rotationImag(paddedBins, 0.f),
+    packedInput(maxFFTSize),
+    packedOutput(maxFFTSize)
+{
+    windowWeights.fill(0.f);
+    derivativeWeights.fill(0.f);
+
+    for (auto& spectrum : splitSpectra) {
+        spectrum.assign(SpectralFrame::maxBins, 0.f);
+    }
+}
+
+bool SlidingDFT::supports(AnalysisConfiguration::Window window) {
+    auto terms = AnalysisConfiguration::getCosineSumTerms(window);
+    return !terms.empty() && (int)terms.size() <= maxTerms;
+}
+
+void SlidingDFT::updateParameters(const AnalysisConfiguration* _configuration, float _despecklingCutoff) {
+    despecklingCutoff = _despecklingCutoff;
+
+    if (_configuration == configuration) {
+        return;
+    }
+
+    configuration = _configuration;
+
+    if (configuration == nullptr) {
+        fftSize = 0;
+        return;
+    }
+
+    jassert(supports(configuration->window) && configuration->fftSize <= maxFFTSize);
+    fftSize = configuration->fftSize;
+
+    if (fft == nullptr || fft->getSize() != fftSize) {
+        fft = std::make_unique<juce::dsp::FFT>(configuration->fftOrder);
+    }
+
+    // Moving the window on a sample turns bin k by 2 pi k / fftSize.
+    for (int k = 0; k <= fftSize / 2; k++) {
+        double angle = juce::MathConstants<double>::twoPi * k / fftSize;
+        rotationReal[(size_t)(k + padding)] = (float)std::cos(angle);
+        rotationImag[(size_t)(k + padding)] = (float)std::sin(angle);
+    }
+
+    // Halved because each cosine is two shifted copies of the spectrum, and scaled like FFTDataGenerator::doFFT
+    // and to Blackman-Harris's coherent gain, which for a periodic cosine sum is just its first term.
+    auto terms = AnalysisConfiguration::getCosineSumTerms(configuration->window);
+    auto blackmanHarrisTerms = AnalysisConfiguration::getCosineSumTerms(AnalysisConfiguration::Window::blackmanHarris);
+    double outputScale = 2.0 / fftSize * blackmanHarrisTerms[0] / terms[0];
+    numTerms = (int)terms.size();
+
+    for (int j = 0; j < numTerms; j++) {
+        double sign = (j & 1) ? -1.0 : 1.0;
+        windowWeights[(size_t)j] = (float)(sign * terms[(size_t)j] * (j == 0 ? 1.0 : 0.5) * outputScale);
+        derivativeWeights[(size_t)j] = (float)(sign * terms[(size_t)j] * juce::MathConstants<double>::pi * j / fftSize * outputScale);
+    }
+
+    resync();
+}
+
+bool SlidingDFT::isActive() const {
+    return configuration != nullptr;
+}
+
+void SlidingDFT::setSampleRate(float _sampleRate) {
+    sampleRate = _sampleRate;
+}
+
+void SlidingDFT::reset() {
+    std::fill(history.begin(), history.end(), 0.f);
+    historyPosition = 0;
+
+    // The spectra of silence.
+    std::fill(plainReal.begin(), plainReal.end(), 0.f);
+    std::fill(plainImag.begin(), plainImag.end(), 0.f);
+    std::fill(timedReal.begin(), timedReal.end(), 0.f);
+    std::fill(timedImag.begin(), timedImag.end(), 0.f);
+    samplesSinceResync = 0;
+}
+
+void SlidingDFT::push(const float* samples, int numSamples) {
+    if (configuration == nullptr) {
+        for (int i = 0; i < numSamples; i++) {
+            history[(size_t)historyPosition] = samples[i];
+            historyPosition = (historyPosition + 1) & (maxFFTSize - 1);
+        }
+
+        return;
+    }
+
+    int numBins = fftSize / 2 + 1;
+    float centre = fftSize * 0.5f;
+    float* pr = plainReal.data() + padding;
+    float* pi = plainImag.data() + padding;
+    float* tr = timedReal.data() + padding;
+    float* ti = timedImag.data() + padding;
+    const float* rr = rotationReal.data() + padding;
+    const float* ri = rotationImag.data() + padding;
+
+    for (int i = 0; i < numSamples; i++) {
+        float newest = samples[i];
+        float oldest = history[(size_t)((historyPosition - fftSize) & (maxFFTSize - 1))];
+        history[(size_t)historyPosition] = newest;
+        historyPosition = (historyPosition + 1) & (maxFFTSize - 1);
+
+        // Every sample moves a place earlier, so the time weights all drop by one. The oldest sample leaves
+        // from time -centre and the newest arrives at fftSize - 1 - centre.
+        float plainChange = newest - oldest;
+        float timedChange = (1.f + centre) * oldest + (fftSize - 1 - centre) * newest;
+
+        for (int k = 0; k < numBins; k++) {
+            float plainR = pr[k] + plainChange;
+            float plainI = pi[k];
+            float timedR = tr[k] - pr[k] + timedChange;
+            float timedI = ti[k] - pi[k];
+
+            pr[k] = plainR * rr[k] - plainI * ri[k];
+            pi[k] = plainR * ri[k] + plainI * rr[k];
+            tr[k] = timedR * rr[k] - timedI * ri[k];
+            ti[k] = timedR * ri[k] + timedI * rr[k];
+        }
+    }
+
+    samplesSinceResync += numSamples;
+
+    if (samplesSinceResync >= fftSize) {
+        resync();
+    }
+}
+
+void SlidingDFT::reassignedSpectrogram(float* times, float* frequencies, float* magnitudes, float* standardFFTResult) {
+    jassert(configuration != nullptr);
+
+    mirrorEdges(plainReal.data(), plainImag.data());
+    mirrorEdges(timedReal.data(), timedImag.data());
+
+    applyWindow(plainReal.data(), plainImag.data(), splitSpectra[0].data(), splitSpectra[1].data(), splitSpectra[2].data(), splitSpectra[3].data());
+    applyWindow(timedReal.data(), timedImag.data(), splitSpectra[4].data(), splitSpectra[5].data(), splitSpectra[6].data(), splitSpectra[7].data());
+
+    ReassignmentSpectra spectra;
+    spectra.real = splitSpectra[0].data();
+    spectra.imag = splitSpectra[1].data();
+    spectra.derivativeReal = splitSpectra[2].data();
+    spectra.derivativeImag = splitSpectra[3].data();
+    spectra.timeWeightedReal = splitSpectra[4].data();
+    spectra.timeWeightedImag = splitSpectra[5].data();
+    spectra.derivativeTimeWeightedReal = splitSpectra[6].data();
+    spectra.derivativeTimeWeightedImag = splitSpectra[7].data();
+
+    float fftBinSize = sampleRate / (float)fftSize;
+    ReassignmentKernel::process(spectra, fftSize / 2, sampleRate, fftBinSize, despecklingCutoff, times, frequencies, magnitudes, standardFFTResult);
+}
+
+void SlidingDFT::resync() {
+    // The time weights are divided by the centre so both halves of the packed FFT are about the same size,
+    // and neither loses precision to the other.
+    float centre = fftSize * 0.5f;
+    int start = historyPosition - fftSize;
+
+    for (int m = 0; m < fftSize; m++) {
+        float sample = history[(size_t)((start + m) & (maxFFTSize - 1))];
+        packedInput[(size_t)m] = std::complex<float>(sample, sample * (m - centre) / centre);
+    }
+
+    fft->perform(packedInput.data(), packedOutput.data(), false);
+
+    // With Z = FFT(a + ib):  A[k] = (Z[k] + conj(Z[N - k])) / 2  and  B[k] = (Z[k] - conj(Z[N - k])) / 2i.
+    for (int k = 0; k <= fftSize / 2; k++) {
+        std::complex<float> z = packedOutput[(size_t)k];
+        std::complex<float> zMirror = packedOutput[(size_t)((fftSize - k) & (fftSize - 1))];
+
+        plainReal[(size_t)(k + padding)] = (z.real() + zMirror.real()) * 0.5f;
+        plainImag[(size_t)(k + padding)] = (z.imag() - zMirror.imag()) * 0.5f;
+        timedReal[(size_t)(k + padding)] = (z.imag() + zMirror.imag()) * 0.5f * centre;
+        timedImag[(size_t)(k + padding)] = (zMirror.real() - z.real()) * 0.5f * centre;
+    }
+
+    samplesSinceResync = 0;
+}
+
+void SlidingDFT::mirrorEdges(float* real, float* imag) const {
+    // The input is real, so bin -k and bin fftSize - k are the conjugate of bin k.
+    int nyquist = fftSize / 2 + padding;
+
+    for (int j = 1; j <= padding; j++) {
+        real[padding - j] = real[padding + j];
+        imag[padding - j] = -imag[padding + j];
+        real[nyquist + j] = real[nyquist - j];
+        imag[nyquist + j] = -imag[nyquist - j];
+    }
+}
+
+void SlidingDFT::applyWindow(const float* real, const float* imag, float* windowedReal, float* windowedImag,
+                             float* derivativeReal, float* derivativeImag) const {
+    // A cosine in time shifts copies of the spectrum up and down by its number of cycles, and the derivative's
+    // sines do the same with a quarter turn.
+    real += padding;
+    imag += padding;
+
+    for (int k = 0; k < fftSize / 2; k++) {
+        float wr = windowWeights[0] * real[k];
+        float wi = windowWeights[0] * imag[k];
+        float dr = 0.f;
+        float di = 0.f;
+
+        for (int j = 1; j < numTerms; j++) {
+            wr += windowWeights[(size_t)j] * (real[k - j] + real[k + j]);
+            wi += windowWeights[(size_t)j] * (imag[k - j] + imag[k + j]);
+            dr -= derivativeWeights[(size_t)j] * (imag[k - j] - imag[k + j]);
+            di += derivativeWeights[(size_t)j] * (real[k - j] - real[k + j]);
+        }
+
+        windowedReal[k] = wr;
+        windowedImag[k] = wi;
+        derivativeReal[k] = dr;
+        derivativeImag[k] = di;
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <JuceHeader.h>
+#include "AnalysisConfiguration.h"
+#include "ReassignmentKernel.h"
+#include "SpectralFrame.h"
+
+// Keeps the spectra of the latest fftSize samples up to date one sample at a time, for hops so small that two
+// FFTs per hop would cost more than sliding every bin along. Two unwindowed spectra are slid, the plain one and one
+// weighted by time from the centre, and the four windowed spectra the reassignment needs are got from those by
+// convolving with the window's few cosine terms. That's exact for cosine-sum windows, in their periodic form
+// (a period of fftSize rather than fftSize - 1), so times come out relative to sample fftSize / 2.
+// Rounding builds up in the recursion, so every fftSize samples both spectra are recomputed with one FFT.
+class SlidingDFT
+{
+public:
+    // Sliding costs about 8 flops per bin per sample, the two FFTs about 10 * log2(fftSize) per bin per hop,
+    // so past this the FFTs are cheaper (see the slidingDFT benchmark).
+    static constexpr int maxHopSize = 16;
+
+    SlidingDFT(int _sampleRate);
+
+    // Whether the window can be slid, see AnalysisConfiguration::getCosineSumTerms().
+    static bool supports(AnalysisConfiguration::Window window);
+
+    // With nullptr it only keeps the history, so it can start sliding straight away when it's needed again.
+    // Not real-time safe when the configuration changes.
+    void updateParameters(const AnalysisConfiguration* _configuration, float _despecklingCutoff);
+
+    bool isActive() const;
+
+    // The rate of the samples it's pushed, when that isn't the one it was made with (see Decimator).
+    void setSampleRate(float _sampleRate);
+
+    void reset();
+
+    void push(const float* samples, int numSamples);
+
+    // Same outputs as FFTDataGenerator::reassignedSpectrogram(), for the latest fftSize samples pushed.
+    void reassignedSpectrogram(float* times, float* frequencies, float* magnitudes, float* standardFFTResult);
+
+private:
+    static constexpr int maxTerms = 4;
+
+    // Bins either side of 0 ... fftSize / 2, mirrored from inside so the window's terms never run off the end.
+    static constexpr int padding = maxTerms - 1;
+    static constexpr int paddedBins = SpectralFrame::maxBins + 1 + 2 * padding;
+
+    float sampleRate;
+    const AnalysisConfiguration* configuration;
+    int fftSize;
+
+    // Its own plan for the resyncs, like FFTDataGenerator's.
+    std::unique_ptr<juce::dsp::FFT> fft;
+    float despecklingCutoff;
+
+    // The window's cosine terms, already scaled to what FFTDataGenerator outputs, and the same for its derivative.
+    int numTerms;
+    std::array<float, maxTerms> windowWeights;
+    std::array<float, maxTerms> derivativeWeights;
+
+    // The last maxFFTSize samples whatever the size, so a new size can be synced straight from them.
+    std::vector<float> history;
+    int historyPosition;
+    int samplesSinceResync;
+
+    // Bin k is at k + padding.
+    std::vector<float> plainReal, plainImag, timedReal, timedImag;
+    std::vector<float> rotationReal, rotationImag;
+
+    std::vector<std::complex<float>> packedInput, packedOutput;
+    std::array<std::vector<float>, 8> splitSpectra;
+
+    void resync();
+
+    void mirrorEdges(float* real, float* imag) const;
+
+    void applyWindow(const float* real, const float* imag, float* windowedReal, float* windowedImag,
+                     float* derivativeReal, float* derivativeImag) const;
+
+    JUCE_DECLARE_NON_COPYABLE(SlidingDFT)
+};
@@ -0,0 +1,235 @@
+#include "SpectralAnalyser.h"
+#include "AllocationGuard.h"
+
+SpectralAnalyser::SpectralAnalyser(int _sampleRate):
+    sampleRate(_sampleRate),
+    decimatedBuffer(1, decimatorBlockSize),
+    fftDataGenerator(_sampleRate),
+    multiResolution(_sampleRate),
+    slidingDFT(_sampleRate),
+    accumulator(_sampleRate),
+    ringBuffer(1, SpectralFrame::maxFFTSize),
+    frameBuffer(1, SpectralFrame::maxFFTSize),
+    configuration(nullptr),
+    recorder(nullptr),
+    recorderStream(0),
+    fftSize(0),
+    hopSize(512),
+    samplesUntilNextFrame(512),
+    noiseFloorDb(-100.f),
+    isMultiResolution(false),
+    isTrackingPartials(false),
+    samplePosition(0)
+{
+}
+
+void SpectralAnalyser::updateParameters(const AnalysisConfiguration* _configuration, int _hopSize, float _despecklingCutoff, float _noiseFloorDb,
+                                        const AnalysisConfigurationCache* multiResolutionConfigurations) {
+    jassert(_hopSize > 0);
+    noiseFloorDb = _noiseFloorDb;
+
+    if (_configuration != nullptr) {
+        jassert(_configuration->fftSize <= SpectralFrame::maxFFTSize);
+
+        configuration = _configuration;
+        fftSize = configuration->fftSize;
+
+        // The ring always holds the largest window, so only the frame buffer's view needs to change.
+        frameBuffer.setSize(frameBuffer.getNumChannels(), fftSize, false, false, true);
+    }
+
+    if (configuration != nullptr) {
+        fftDataGenerator.updateParameters(*configuration, _despecklingCutoff);
+    }
+
+    isMultiResolution = multiResolutionConfigurations != nullptr;
+
+    if (isMultiResolution && configuration != nullptr) {
+        multiResolution.updateParameters(*multiResolutionConfigurations, configuration->window, _despecklingCutoff);
+    }
+
+    if (_hopSize != hopSize) {
+        hopSize = _hopSize;
+        samplesUntilNextFrame = juce::jmin(samplesUntilNextFrame, hopSize);
+    }
+
+    bool shouldSlide = configuration != nullptr && !isMultiResolution && hopSize <= SlidingDFT::maxHopSize
+                    && SlidingDFT::supports(configuration->window);
+    slidingDFT.updateParameters(shouldSlide ? configuration : nullptr, _despecklingCutoff);
+}
+
+void SpectralAnalyser::updateAccumulator(FrequencyAxis::Scale scale, float minFrequency, float maxFrequency, int numRows) {
+    if (configuration != nullptr) {
+        accumulator.prepare(scale, minFrequency, maxFrequency, numRows, fftSize, hopSize);
+    }
+}
+
+void SpectralAnalyser::setMaxFrequency(float maxFrequency) {
+    int factor = Decimator::getFactorFor(sampleRate, maxFrequency);
+
+    if (factor != decimator.getFactor()) {
+        setDecimation(factor);
+    }
+}
+
+void SpectralAnalyser::setSampleRate(double _sampleRate) {
+    sampleRate = _sampleRate;
+    multiResolution.setSampleRate((float)sampleRate);
+
+    // The factor may not suit the new rate, but the next setMaxFrequency() sorts that out.
+    setDecimation(decimator.getFactor());
+    reset();
+}
+
+void SpectralAnalyser::reset() {
+    ringBuffer.clear();
+    decimator.reset();
+    slidingDFT.reset();
+    accumulator.reset();
+    tracker.reset();
+    multiResolution.reset();
+    samplesUntilNextFrame = hopSize;
+    samplePosition = 0;
+}
+
+void SpectralAnalyser::process(const juce::AudioBuffer<float>& buffer, int channel, int startSample, int numSamples, SpectralFrameQueue& queue, bool coalesce) {
+    AllocationGuard noAllocations;
+
+    bool hasCoalescedFrame = false;
+
+    if (decimator.getFactor() == 1) {
+        samplePosition += numSamples;
+        pushAnalysedSamples(buffer, channel, startSample, numSamples, samplePosition, queue, coalesce, hasCoalescedFrame);
+    }
+    else {
+        for (int position = startSample; position < startSample + numSamples; position += decimatorBlockSize) {
+            int numToDecimate = juce::jmin(decimatorBlockSize, startSample + numSamples - position);
+            int numDecimated = decimator.process(buffer.getReadPointer(channel, position), numToDecimate, decimatedBuffer.getWritePointer(0));
+            samplePosition += numToDecimate;
+
+            // The filters delay everything, so the newest decimated sample is from a little while ago.
+            pushAnalysedSamples(decimatedBuffer, 0, 0, numDecimated, samplePosition - decimator.getLatency(), queue, coalesce, hasCoalescedFrame);
+        }
+    }
+
+    if (hasCoalescedFrame) {
+        analyseLatestWindow(queue, true, samplePosition - decimator.getLatency());
+    }
+}
+
+void SpectralAnalyser::pushAnalysedSamples(const juce::AudioBuffer<float>& buffer, int channel, int startSample, int numSamples,
+                                           juce::int64 newestPosition, SpectralFrameQueue& queue, bool coalesce, bool& hasCoalescedFrame) {
+    int position = startSample;
+    int end = startSample + numSamples;
+
+    while (position < end) {
+        int numToPush = juce::jmin(end - position, samplesUntilNextFrame);
+
+        ringBuffer.push(buffer, channel, position, numToPush);
+        slidingDFT.push(buffer.getReadPointer(channel, position), numToPush);
+        position += numToPush;
+        samplesUntilNextFrame -= numToPush;
+
+        if (samplesUntilNextFrame == 0) {
+            if (coalesce) {
+                hasCoalescedFrame = true;
+            }
+            else {
+                analyseLatestWindow(queue, false, newestPosition - (juce::int64)(end - position) * decimator.getFactor());
+            }
+
+            samplesUntilNextFrame = hopSize;
+        }
+    }
+}
+
+void SpectralAnalyser::skip(juce::int64 numSamples) {
+    // Joining what's buffered from before the gap to what comes after it would draw a click that was never in the
+    // signal, so start over, and the first frame after the gap only covers contiguous audio.
+    auto position = samplePosition + numSamples;
+    reset();
+    samplePosition = position;
+}
+
+void SpectralAnalyser::setPartialTracking(bool shouldTrack) {
+    if (shouldTrack && !isTrackingPartials) {
+        tracker.reset();
+    }
+
+    isTrackingPartials = shouldTrack;
+}
+
+void SpectralAnalyser::setRecorder(SpectralRecorder* _recorder, int _recorderStream) {
+    recorder = _recorder;
+    recorderStream = _recorderStream;
+}
+
+void SpectralAnalyser::analyseLatestWindow(SpectralFrameQueue& queue, bool coalesced, juce::int64 windowEndPosition) {
+    if (configuration == nullptr || (isMultiResolution && !multiResolution.isReady())) {
+        return;
+    }
+
+    // If the editor isn't draining the queue (e.g. it's closed) the frame is counted as dropped,
+    // and unless it's being recorded there's no point analysing it.
+    bool isRecording = recorder != nullptr && recorder->isRecording();
+    auto* queuedFrame = queue.beginWrite();
+
+    if (queuedFrame == nullptr && !isRecording) {
+        return;
+    }
+
+    auto& frame = queuedFrame != nullptr ? *queuedFrame : recorderFrame;
+
+    if (isMultiResolution) {
+        // A coalesced frame stands in for several hops, so it might as well have every size up to date.
+        multiResolution.analyse(ringBuffer, frame, coalesced);
+    }
+    else if (slidingDFT.isActive()) {
+        frame.fftSize = fftSize;
+        frame.numBins = fftSize / 2;
+        frame.numPoints = fftSize / 2;
+        slidingDFT.reassignedSpectrogram(frame.times.data(), frame.frequencies.data(), frame.magnitudes.data(), frame.standardFFTResult.data());
+    }
+    else {
+        ringBuffer.copyLatest(frameBuffer, fftSize);
+        fftDataGenerator.reassignedSpectrogram(frameBuffer, frame);
+    }
+
+    // Everything after this, the queue included, only deals with the points that will actually show.
+    frame.numPoints = ReassignmentKernel::keepPoints(frame.times.data(), frame.frequencies.data(), frame.magnitudes.data(), frame.numPoints, noiseFloorDb);
+
+    frame.samplePosition = windowEndPosition;
+    frame.decimation = decimator.getFactor();
+    frame.sampleRate = (float)sampleRate;
+    accumulator.process(frame);
+
+    if (isTrackingPartials) {
+        tracker.process(frame);
+    }
+    else {
+        frame.numPartialSegments = 0;
+    }
+
+    if (isRecording) {
+        recorder->writeFrame(recorderStream, frame);
+    }
+
+    if (queuedFrame != nullptr) {
+        queue.finishWrite();
+    }
+}
+
+void SpectralAnalyser::setDecimation(int factor) {
+    decimator.setFactor(factor);
+
+    float analysedSampleRate = (float)(sampleRate / factor);
+    fftDataGenerator.setSampleRate(analysedSampleRate);
+    slidingDFT.setSampleRate(analysedSampleRate);
+    accumulator.setSampleRate(analysedSampleRate);
+
+    ringBuffer.clear();
+    slidingDFT.reset();
+    accumulator.reset();
+    tracker.reset();
+    samplesUntilNextFrame = hopSize;
+}
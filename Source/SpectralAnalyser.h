@@ -0,0 +1,95 @@
+#pragma once
+#include <JuceHeader.h>
+#include "AnalysisRingBuffer.h"
+#include "Decimator.h"
+#include "FFTDataGenerator.h"
+#include "MultiResolutionAnalysis.h"
+#include "PartialTracker.h"
+#include "ReassignedAccumulator.h"
+#include "SlidingDFT.h"
+#include "SpectralFrameQueue.h"
+#include "SpectralRecorder.h"
+
+// Streams one channel of audio through an AnalysisRingBuffer and runs the reassignment every hopSize samples,
+// so the frame rate only depends on the hop and not on how the host slices its blocks.
+// Each analysed channel (or derived signal like mid / side) gets its own analyser.
+class SpectralAnalyser
+{
+public:
+    SpectralAnalyser(int _sampleRate);
+
+    // Until the first configuration arrives the analyser keeps filling its history but emits no frames.
+    // Given the cache, every size in it is fused instead (see MultiResolutionAnalysis). The configuration should
+    // then be the largest one and the hop the smallest size's. Otherwise hops of up to SlidingDFT::maxHopSize
+    // slide the spectra along instead of running FFTs, when the window allows. Only points above the noise floor
+    // are sent on.
+    void updateParameters(const AnalysisConfiguration* _configuration, int _hopSize, float _despecklingCutoff, float _noiseFloorDb,
+                          const AnalysisConfigurationCache* multiResolutionConfigurations = nullptr);
+
+    // Not real-time safe. The rows the reassigned points are accumulated onto, see ReassignedAccumulator.
+    // Call it after updateParameters(). With fewer than 2 rows nothing is accumulated.
+    void updateAccumulator(FrequencyAxis::Scale scale, float minFrequency, float maxFrequency, int numRows);
+
+    // Not real-time safe. Zooms in on 0 Hz to maxFrequency by decimating the input as far as it allows (see
+    // Decimator), so the same FFT size resolves that band more finely. 0 analyses the whole band.
+    // Changing the factor starts the analysis over, as the old samples were at another rate.
+    void setMaxFrequency(float maxFrequency);
+
+    // Not real-time safe. The rate of the samples it's given, which starts the analysis over.
+    void setSampleRate(double _sampleRate);
+
+    void reset();
+
+    // Emits zero, one or many frames into the queue depending on how many hop boundaries the samples cross.
+    // When coalescing, all of those frames are collapsed into one for the latest window.
+    void process(const juce::AudioBuffer<float>& buffer, int channel, int startSample, int numSamples, SpectralFrameQueue& queue, bool coalesce = false);
+
+    // Accounts for samples that were thrown away without being analysed, so frame positions stay on the same clock.
+    // Starts the analysis over after them, like reset().
+    void skip(juce::int64 numSamples);
+
+    // Links each frame's points into partials, see PartialTracker. Turning it on starts from no tracks.
+    void setPartialTracking(bool shouldTrack);
+
+    // Every frame is also offered to the recorder as this stream, even when the queue has no room for it.
+    void setRecorder(SpectralRecorder* _recorder, int _recorderStream);
+
+private:
+    // How much input is decimated at a time.
+    static constexpr int decimatorBlockSize = 4096;
+
+    double sampleRate;
+    Decimator decimator;
+    juce::AudioBuffer<float> decimatedBuffer;
+    FFTDataGenerator fftDataGenerator;
+    MultiResolutionAnalysis multiResolution;
+    SlidingDFT slidingDFT;
+    ReassignedAccumulator accumulator;
+    PartialTracker tracker;
+    AnalysisRingBuffer ringBuffer;
+    juce::AudioBuffer<float> frameBuffer;
+    const AnalysisConfiguration* configuration;
+    SpectralRecorder* recorder;
+    int recorderStream;
+
+    // Somewhere to analyse into when the queue is full but the recorder still wants the frame.
+    SpectralFrame recorderFrame;
+
+    int fftSize;
+    int hopSize;
+    int samplesUntilNextFrame;
+    float noiseFloorDb;
+    bool isMultiResolution;
+    bool isTrackingPartials;
+    juce::int64 samplePosition;
+
+    // Pushes analysed samples (decimated or not) and emits frames at the hop boundaries. newestPosition is where the
+    // last of them ends on the input's clock.
+    void pushAnalysedSamples(const juce::AudioBuffer<float>& buffer, int channel, int startSample, int numSamples,
+                             juce::int64 newestPosition, SpectralFrameQueue& queue, bool coalesce, bool& hasCoalescedFrame);
+
+    void analyseLatestWindow(SpectralFrameQueue& queue, bool coalesced, juce::int64 windowEndPosition);
+
+    // Switches to decimating by factor and starts the analysis over.
+    void setDecimation(int factor);
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <JuceHeader.h>
+
+// One analysed frame, as handed from the processor to the editor.
+// The storage is fixed-size so that frames can live in a preallocated queue
+// and be filled in place without touching the allocator.
+struct SpectralFrame
+{
+    static constexpr int maxFFTSize = 8192;
+    static constexpr int maxBins = maxFFTSize / 2;
+    static constexpr int maxAccumulatedRows = 2048;
+    static constexpr int maxPartialSegments = 512;
+
+    // Absolute position (in samples since playback was prepared) of the last sample in the analysed window.
+    juce::int64 samplePosition = 0;
+    int fftSize = 0;
+    int numBins = 0;
+
+    // Input samples per analysed sample, see Decimator. The window and bins are at the input's rate / decimation,
+    // so the window covers fftSize * decimation input samples.
+    int decimation = 1;
+
+    // The input's rate, which samplePosition counts at.
+    float sampleRate = 48000.f;
+
+    // The reassigned points, only the first numPoints of each. Once the analyser has gated them they're only
+    // the ones above the noise floor that passed despeckling, so usually far fewer than numBins.
+    int numPoints = 0;
+    std::array<float, maxBins> times;
+    std::array<float, maxBins> frequencies;
+    std::array<float, maxBins> magnitudes;
+
+    // Every bin's standard magnitude in dB, numBins of them.
+    std::array<float, maxBins> standardFFTResult;
+
+    // A finished column of reassigned energy in dB on the display's rows, row 0 at the bottom, from a
+    // ReassignedAccumulator. It belongs to an earlier frame than the points above. 0 rows if nothing accumulated it.
+    int numAccumulatedRows = 0;
+    std::array<float, maxAccumulatedRows> accumulated;
+
+    // Where the accumulated column's time is centred, on the same clock as samplePosition.
+    juce::int64 accumulatedSamplePosition = 0;
+
+    // A straight piece of a partial from a PartialTracker, between two points it linked. Times are relative to this
+    // frame's centre like the points', and the magnitude is the end's, in dB.
+    struct PartialSegment
+    {
+        int trackId;
+        float startTime;
+        float startFrequency;
+        float endTime;
+        float endFrequency;
+        float magnitude;
+    };
+
+    // What the tracks added this frame, only the first numPartialSegments. 0 unless partials are being tracked.
+    int numPartialSegments = 0;
+    std::array<PartialSegment, maxPartialSegments> partialSegments;
+};
@@ -0,0 +1,48 @@
+#include "SpectralFrameQueue.h"
+
+// AbstractFifo always keeps one slot free, so allocate one more than we need.
+SpectralFrameQueue::SpectralFrameQueue(int _capacity):
+    fifo(_capacity + 1),
+    frames(_capacity + 1),
+    numDropped(0)
+{
+}
+
+SpectralFrame* SpectralFrameQueue::beginWrite() {
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 == 0) {
+        numDropped++;
+        return nullptr;
+    }
+
+    return &frames[start1];
+}
+
+void SpectralFrameQueue::finishWrite() {
+    fifo.finishedWrite(1);
+}
+
+const SpectralFrame* SpectralFrameQueue::beginRead() {
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(1, start1, size1, start2, size2);
+
+    if (size1 == 0) {
+        return nullptr;
+    }
+
+    return &frames[start1];
+}
+
+void SpectralFrameQueue::finishRead() {
+    fifo.finishedRead(1);
+}
+
+int SpectralFrameQueue::getNumReady() const {
+    return fifo.getNumReady();
+}
+
+int SpectralFrameQueue::getNumDropped() const {
+    return numDropped.load();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SpectralFrame.h"
+
+// Wait-free single-producer / single-consumer ring of spectral frames.
+// The producer fills a slot in place between beginWrite() and finishWrite(),
+// the consumer reads it in place between beginRead() and finishRead().
+class SpectralFrameQueue
+{
+public:
+    SpectralFrameQueue(int _capacity);
+
+    // Producer side. Returns nullptr (and counts the frame as dropped) when the consumer has fallen behind.
+    SpectralFrame* beginWrite();
+    void finishWrite();
+
+    // Consumer side. Returns nullptr when there is nothing new to read.
+    const SpectralFrame* beginRead();
+    void finishRead();
+
+    int getNumReady() const;
+    int getNumDropped() const;
+
+private:
+    juce::AbstractFifo fifo;
+    std::vector<SpectralFrame> frames;
+    std::atomic<int> numDropped;
+
+    JUCE_DECLARE_NON_COPYABLE(SpectralFrameQueue)
+};
@@ -0,0 +1,206 @@
+#include "SpectralRecorder.h"
+
+using namespace RecordingFormat;
+
+static constexpr int maxRecordBytes = (int)(sizeof(juce::uint32) + sizeof(FrameHeader) + SpectralFrame::maxBins * sizeof(Point));
+
+SpectralRecorder::StreamQueue::StreamQueue():
+    queue(queueBytesPerStream),
+    scratch((size_t)maxRecordBytes)
+{
+}
+
+SpectralRecorder::SpectralRecorder():
+    juce::Thread("Spectral recorder"),
+    record((size_t)maxRecordBytes),
+    recording(false),
+    numDroppedFrames(0)
+{
+}
+
+SpectralRecorder::~SpectralRecorder() {
+    stop();
+}
+
+juce::Result SpectralRecorder::start(const juce::File& _file, const Settings& _settings) {
+    stop();
+
+    jassert(_settings.numStreams <= maxStreams);
+
+    file = _file;
+    settings = _settings;
+
+    file.deleteFile();
+    stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (stream->failedToOpen()) {
+        stream.reset();
+        return juce::Result::fail("Couldn't open " + file.getFullPathName() + " for writing");
+    }
+
+    FileHeader header;
+    header.sampleRate = settings.sampleRate;
+    header.fftSize = (juce::uint32)settings.fftSize;
+    header.hopSize = (juce::uint32)settings.hopSize;
+    header.window = settings.window;
+    header.numStreams = (juce::uint32)settings.numStreams;
+    header.floorDb = settings.floorDb;
+    stream->write(&header, sizeof(header));
+
+    chunk.reset();
+    chunkHeader = ChunkHeader();
+    index.clear();
+
+    // Queues are only ever added, so an analysis thread that still holds one from the last take stays safe.
+    for (int i = 0; i < settings.numStreams; i++) {
+        if (streamQueues[i] == nullptr) {
+            streamQueues[i] = std::make_unique<StreamQueue>();
+        }
+
+        streamQueues[i]->queue.reset();
+    }
+
+    numDroppedFrames = 0;
+    recording = true;
+    startThread(juce::Thread::Priority::low);
+
+    return juce::Result::ok();
+}
+
+void SpectralRecorder::stop() {
+    if (stream == nullptr) {
+        return;
+    }
+
+    recording = false;
+    stopThread(5000);
+
+    // The writer has stopped, so it's safe to finish its work from here.
+    drainQueues();
+    flushChunk();
+    writeIndex();
+
+    stream->flush();
+    stream.reset();
+}
+
+bool SpectralRecorder::isRecording() const {
+    return recording.load();
+}
+
+juce::File SpectralRecorder::getFile() const {
+    return file;
+}
+
+void SpectralRecorder::writeFrame(int streamIndex, const SpectralFrame& frame) {
+    if (!recording.load() || streamIndex < 0 || streamIndex >= settings.numStreams) {
+        return;
+    }
+
+    auto& target = *streamQueues[streamIndex];
+    auto analysedRate = settings.sampleRate / frame.decimation;
+    auto* points = target.scratch + sizeof(juce::uint32) + sizeof(FrameHeader);
+    int numPoints = 0;
+
+    for (int i = 0; i < frame.numPoints; i++) {
+        if (frame.magnitudes[i] > settings.floorDb) {
+            auto point = quantise(frame.times[i], frame.frequencies[i], frame.magnitudes[i], analysedRate);
+            std::memcpy(points + numPoints * sizeof(Point), &point, sizeof(Point));
+            numPoints++;
+        }
+    }
+
+    FrameHeader header;
+    header.samplePosition = frame.samplePosition;
+    header.stream = (juce::uint8)streamIndex;
+    header.fftOrder = (juce::uint8)juce::findHighestSetBit((juce::uint32)frame.fftSize);
+    header.numPoints = (juce::uint16)numPoints;
+    header.decimation = (juce::uint16)frame.decimation;
+
+    juce::uint32 size = (juce::uint32)(sizeof(FrameHeader) + numPoints * sizeof(Point));
+    std::memcpy(target.scratch, &size, sizeof(size));
+    std::memcpy(target.scratch + sizeof(size), &header, sizeof(header));
+
+    if (!target.queue.write(target.scratch, (int)(sizeof(size) + size))) {
+        numDroppedFrames++;
+    }
+}
+
+int SpectralRecorder::getNumDroppedFrames() const {
+    return numDroppedFrames.load();
+}
+
+void SpectralRecorder::run() {
+    while (!threadShouldExit()) {
+        wait(writeIntervalMs);
+
+        if (!drainQueues()) {
+            // Most likely the disk is full. Stop taking frames rather than queueing them up forever.
+            recording = false;
+            return;
+        }
+    }
+}
+
+bool SpectralRecorder::drainQueues() {
+    for (int i = 0; i < settings.numStreams; i++) {
+        auto& queue = streamQueues[i]->queue;
+        juce::uint32 size;
+
+        while (queue.peek(&size, sizeof(size)) && queue.read(record, (int)(sizeof(size) + size))) {
+            FrameHeader header;
+            std::memcpy(&header, record + sizeof(size), sizeof(header));
+
+            if (chunkHeader.numFrames == 0) {
+                chunkHeader.firstSamplePosition = header.samplePosition;
+                chunkHeader.lastSamplePosition = header.samplePosition;
+            }
+
+            // Streams are drained one after the other, so a chunk's frames aren't strictly in order.
+            chunkHeader.firstSamplePosition = juce::jmin(chunkHeader.firstSamplePosition, header.samplePosition);
+            chunkHeader.lastSamplePosition = juce::jmax(chunkHeader.lastSamplePosition, header.samplePosition);
+            chunkHeader.numFrames++;
+            chunk.write(record + sizeof(size), size);
+
+            if (chunkHeader.numFrames >= framesPerChunk && !flushChunk()) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool SpectralRecorder::flushChunk() {
+    if (chunkHeader.numFrames == 0) {
+        return true;
+    }
+
+    IndexEntry entry;
+    entry.fileOffset = (juce::uint64)stream->getPosition();
+    entry.firstSamplePosition = chunkHeader.firstSamplePosition;
+    entry.lastSamplePosition = chunkHeader.lastSamplePosition;
+    entry.numFrames = chunkHeader.numFrames;
+
+    chunkHeader.payloadBytes = (juce::uint32)chunk.getDataSize();
+    stream->write(&chunkHeader, sizeof(chunkHeader));
+    stream->write(chunk.getData(), chunk.getDataSize());
+
+    // Flushed chunk by chunk, so a crash loses at most the one being filled.
+    stream->flush();
+
+    index.push_back(entry);
+    chunk.reset();
+    chunkHeader = ChunkHeader();
+
+    return stream->getStatus().wasOk();
+}
+
+void SpectralRecorder::writeIndex() {
+    Trailer trailer;
+    trailer.indexOffset = (juce::uint64)stream->getPosition();
+    trailer.numEntries = (juce::uint32)index.size();
+
+    stream->write(index.data(), index.size() * sizeof(IndexEntry));
+    stream->write(&trailer, sizeof(trailer));
+}
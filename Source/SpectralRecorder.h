@@ -0,0 +1,76 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ByteQueue.h"
+#include "RecordingFormat.h"
+#include "SpectralFrame.h"
+
+// Records the analysed frames to a .rspg file (see RecordingFormat.h).
+// The analysis threads quantise each frame into a per-stream lock-free queue, and a background thread
+// gathers those into chunks and does all of the file I/O, so nothing on the analysis or audio side ever waits on the disk.
+class SpectralRecorder : private juce::Thread
+{
+public:
+    struct Settings
+    {
+        double sampleRate = 48000;
+        int fftSize = 2048;
+        int hopSize = 256;
+        RecordingFormat::Window window = RecordingFormat::Window::blackmanHarris;
+        int numStreams = 1;
+        float floorDb = -96.f;
+    };
+
+    static constexpr int maxStreams = 8;
+
+    SpectralRecorder();
+    ~SpectralRecorder() override;
+
+    // Message thread. Opens the file, writes the header and starts accepting frames.
+    juce::Result start(const juce::File& file, const Settings& _settings);
+
+    // Message thread. Writes out whatever is still queued, then the index, and closes the file.
+    void stop();
+
+    bool isRecording() const;
+    juce::File getFile() const;
+
+    // Analysis threads, one per stream. Wait-free: if the writer has fallen behind, the frame is dropped and counted.
+    void writeFrame(int stream, const SpectralFrame& frame);
+
+    int getNumDroppedFrames() const;
+
+private:
+    static constexpr int queueBytesPerStream = 1 << 20;
+    static constexpr int framesPerChunk = 256;
+    static constexpr int writeIntervalMs = 20;
+
+    // Each record in a queue is its size in bytes, then a FrameHeader and its points.
+    struct StreamQueue
+    {
+        StreamQueue();
+
+        ByteQueue queue;
+        juce::HeapBlock<char> scratch;
+    };
+
+    Settings settings;
+    juce::File file;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    std::array<std::unique_ptr<StreamQueue>, maxStreams> streamQueues;
+
+    // Only touched by the writer thread (and by stop(), once it has finished).
+    juce::MemoryOutputStream chunk;
+    RecordingFormat::ChunkHeader chunkHeader;
+    std::vector<RecordingFormat::IndexEntry> index;
+    juce::HeapBlock<char> record;
+
+    std::atomic<bool> recording;
+    std::atomic<int> numDroppedFrames;
+
+    void run() override;
+
+    // Moves everything queued into chunks. Returns false if the file couldn't be written.
+    bool drainQueues();
+    bool flushChunk();
+    void writeIndex();
+};
@@ -0,0 +1,211 @@
+#include "SpectralRecordingReader.h"
+
+using namespace RecordingFormat;
+
+// Far past anything we record, it's only there so a corrupt frame header can't overflow fftSize.
+static constexpr juce::uint8 maxFFTOrder = 30;
+
+void SpectralRecordingReader::Frame::getPoint(int pointIndex, double sampleRate, float& time, float& frequency, float& magnitudeDb) const {
+    jassert(pointIndex < numPoints);
+
+    Point point;
+    std::memcpy(&point, points + pointIndex * sizeof(Point), sizeof(Point));
+
+    // Points are stored relative to the centre of their frame's window, which covers fftSize * decimation input samples.
+    auto analysedRate = sampleRate / decimation;
+    double frameCentre = (samplePosition - fftSize * decimation / 2) / sampleRate;
+    time = (float)(frameCentre + getTimeSeconds(point, analysedRate));
+    frequency = RecordingFormat::getFrequency(point, analysedRate);
+    magnitudeDb = RecordingFormat::getMagnitudeDb(point);
+}
+
+SpectralRecordingReader::SpectralRecordingReader():
+    recovered(false)
+{
+}
+
+juce::Result SpectralRecordingReader::open(const juce::File& file) {
+    close();
+
+    mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    if (getData() == nullptr || getSize() < sizeof(FileHeader)) {
+        close();
+        return juce::Result::fail("Couldn't map " + file.getFullPathName());
+    }
+
+    std::memcpy(&header, getData(), sizeof(header));
+
+    if (std::memcmp(header.magic, FileHeader().magic, 4) != 0 || header.version != version) {
+        close();
+        return juce::Result::fail(file.getFileName() + " isn't a version " + juce::String((int)version) + " spectrogram recording");
+    }
+
+    recovered = !readIndex();
+
+    if (recovered) {
+        rebuildIndex();
+    }
+
+    updateSearchBounds();
+
+    return juce::Result::ok();
+}
+
+void SpectralRecordingReader::close() {
+    mappedFile.reset();
+    index.clear();
+    latestSampleUpToChunk.clear();
+    earliestSampleFromChunk.clear();
+    header = FileHeader();
+    recovered = false;
+}
+
+const FileHeader& SpectralRecordingReader::getHeader() const {
+    return header;
+}
+
+int SpectralRecordingReader::getNumChunks() const {
+    return (int)index.size();
+}
+
+juce::int64 SpectralRecordingReader::getFirstSamplePosition() const {
+    return index.empty() ? 0 : earliestSampleFromChunk.front();
+}
+
+juce::int64 SpectralRecordingReader::getLastSamplePosition() const {
+    return index.empty() ? 0 : latestSampleUpToChunk.back();
+}
+
+void SpectralRecordingReader::readRange(juce::int64 startSample, juce::int64 endSample, const std::function<void(const Frame&)>& callback) const {
+    // Skip straight to the first chunk that can overlap the range, and stop once none of the rest can.
+    auto first = std::lower_bound(latestSampleUpToChunk.begin(), latestSampleUpToChunk.end(), startSample);
+
+    for (auto i = (size_t)(first - latestSampleUpToChunk.begin()); i < index.size() && earliestSampleFromChunk[i] < endSample; i++) {
+        auto& entry = index[i];
+
+        if (entry.lastSamplePosition < startSample || entry.firstSamplePosition >= endSample) {
+            continue;
+        }
+
+        // Entries were checked against the file when it was opened, but the frames inside a chunk weren't,
+        // so a corrupt one only ever ends its own chunk early.
+        ChunkHeader chunkHeader;
+        std::memcpy(&chunkHeader, getData() + entry.fileOffset, sizeof(chunkHeader));
+
+        auto* data = getData() + entry.fileOffset + sizeof(ChunkHeader);
+        auto* end = data + chunkHeader.payloadBytes;
+
+        for (juce::uint32 frameIndex = 0; frameIndex < entry.numFrames && (size_t)(end - data) >= sizeof(FrameHeader); frameIndex++) {
+            FrameHeader frameHeader;
+            std::memcpy(&frameHeader, data, sizeof(frameHeader));
+            data += sizeof(frameHeader);
+
+            if ((size_t)(end - data) < frameHeader.numPoints * sizeof(Point) || frameHeader.fftOrder > maxFFTOrder) {
+                break;
+            }
+
+            if (frameHeader.samplePosition >= startSample && frameHeader.samplePosition < endSample) {
+                Frame frame;
+                frame.samplePosition = frameHeader.samplePosition;
+                frame.stream = frameHeader.stream;
+                frame.fftSize = 1 << frameHeader.fftOrder;
+                frame.decimation = juce::jmax(1, (int)frameHeader.decimation);
+                frame.numPoints = frameHeader.numPoints;
+                frame.points = data;
+                callback(frame);
+            }
+
+            data += frameHeader.numPoints * sizeof(Point);
+        }
+    }
+}
+
+bool SpectralRecordingReader::wasRecovered() const {
+    return recovered;
+}
+
+const char* SpectralRecordingReader::getData() const {
+    return mappedFile != nullptr ? static_cast<const char*>(mappedFile->getData()) : nullptr;
+}
+
+size_t SpectralRecordingReader::getSize() const {
+    return mappedFile != nullptr ? mappedFile->getSize() : 0;
+}
+
+bool SpectralRecordingReader::readIndex() {
+    if (getSize() < sizeof(FileHeader) + sizeof(Trailer)) {
+        return false;
+    }
+
+    Trailer trailer;
+    std::memcpy(&trailer, getData() + getSize() - sizeof(Trailer), sizeof(trailer));
+
+    if (std::memcmp(trailer.magic, Trailer().magic, 4) != 0
+        || trailer.indexOffset > getSize()
+        || trailer.indexOffset + (juce::uint64)trailer.numEntries * sizeof(IndexEntry) + sizeof(Trailer) != getSize()) {
+        return false;
+    }
+
+    index.resize(trailer.numEntries);
+    std::memcpy(index.data(), getData() + trailer.indexOffset, index.size() * sizeof(IndexEntry));
+
+    // Every entry has to point at a chunk header that agrees with it and whose payload ends before the index does.
+    for (auto& entry : index) {
+        if (entry.fileOffset < sizeof(FileHeader) || entry.fileOffset > trailer.indexOffset
+            || trailer.indexOffset - entry.fileOffset < sizeof(ChunkHeader)) {
+            index.clear();
+            return false;
+        }
+
+        ChunkHeader chunkHeader;
+        std::memcpy(&chunkHeader, getData() + entry.fileOffset, sizeof(chunkHeader));
+
+        if (std::memcmp(chunkHeader.magic, ChunkHeader().magic, 4) != 0
+            || trailer.indexOffset - entry.fileOffset - sizeof(ChunkHeader) < chunkHeader.payloadBytes
+            || chunkHeader.numFrames != entry.numFrames) {
+            index.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SpectralRecordingReader::rebuildIndex() {
+    // Walk the chunk headers until we run out of file or hit the chunk that was being written when it stopped.
+    index.clear();
+    size_t offset = sizeof(FileHeader);
+
+    while (offset + sizeof(ChunkHeader) <= getSize()) {
+        ChunkHeader chunkHeader;
+        std::memcpy(&chunkHeader, getData() + offset, sizeof(chunkHeader));
+
+        if (std::memcmp(chunkHeader.magic, ChunkHeader().magic, 4) != 0
+            || offset + sizeof(ChunkHeader) + chunkHeader.payloadBytes > getSize()) {
+            break;
+        }
+
+        IndexEntry entry;
+        entry.fileOffset = offset;
+        entry.firstSamplePosition = chunkHeader.firstSamplePosition;
+        entry.lastSamplePosition = chunkHeader.lastSamplePosition;
+        entry.numFrames = chunkHeader.numFrames;
+        index.push_back(entry);
+
+        offset += sizeof(ChunkHeader) + chunkHeader.payloadBytes;
+    }
+}
+
+void SpectralRecordingReader::updateSearchBounds() {
+    latestSampleUpToChunk.resize(index.size());
+    earliestSampleFromChunk.resize(index.size());
+
+    for (size_t i = 0; i < index.size(); i++) {
+        latestSampleUpToChunk[i] = i == 0 ? index[i].lastSamplePosition : juce::jmax(latestSampleUpToChunk[i - 1], index[i].lastSamplePosition);
+    }
+
+    for (size_t i = index.size(); i-- > 0;) {
+        earliestSampleFromChunk[i] = i + 1 == index.size() ? index[i].firstSamplePosition : juce::jmin(earliestSampleFromChunk[i + 1], index[i].firstSamplePosition);
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <JuceHeader.h>
+#include "RecordingFormat.h"
+
+// Random access to a .rspg recording through a read-only memory map, so reviewing an hour-long take
+// only ever touches the pages of the time range being looked at.
+class SpectralRecordingReader
+{
+public:
+    // A view of one frame record inside the mapped file. Only valid while the reader is open.
+    struct Frame
+    {
+        juce::int64 samplePosition;
+        int stream;
+        int fftSize;
+        int decimation;
+        int numPoints;
+
+        // Absolute time (seconds since the recording's sample clock started), frequency (Hz) and magnitude (dB).
+        void getPoint(int index, double sampleRate, float& time, float& frequency, float& magnitudeDb) const;
+
+        const char* points;
+    };
+
+    SpectralRecordingReader();
+
+    juce::Result open(const juce::File& file);
+    void close();
+
+    const RecordingFormat::FileHeader& getHeader() const;
+    int getNumChunks() const;
+    juce::int64 getFirstSamplePosition() const;
+    juce::int64 getLastSamplePosition() const;
+
+    // Calls back with every frame whose sample position lies in [startSample, endSample), chunk by chunk.
+    // Within a chunk frames are in the order they were recorded, which can interleave streams.
+    void readRange(juce::int64 startSample, juce::int64 endSample, const std::function<void(const Frame&)>& callback) const;
+
+    // True if the recording wasn't closed cleanly and the index had to be rebuilt from the chunk headers.
+    bool wasRecovered() const;
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    RecordingFormat::FileHeader header;
+    std::vector<RecordingFormat::IndexEntry> index;
+    bool recovered;
+
+    // Streams are interleaved, so chunk ranges overlap a little and aren't strictly sorted.
+    // These are sorted, and bound where a range can start and stop in the index.
+    std::vector<juce::int64> latestSampleUpToChunk;
+    std::vector<juce::int64> earliestSampleFromChunk;
+
+    const char* getData() const;
+    size_t getSize() const;
+
+    bool readIndex();
+    void rebuildIndex();
+    void updateSearchBounds();
+
+    JUCE_DECLARE_NON_COPYABLE(SpectralRecordingReader)
+};
@@ -0,0 +1,239 @@
+#include "SpectrogramComponent.h"
+
+static_assert(AnalysisWorker::maxStreams <= SpectrogramRenderer::maxStreams, "The renderer needs a column position per stream");
+
+// Before the host has prepared the processor there's no rate yet.
+static float getSampleRateOf(const SpectrogramVSTAudioProcessor& audioProcessor) {
+    return audioProcessor.getSampleRate() > 0 ? (float)audioProcessor.getSampleRate() : 48000.f;
+}
+
+SpectrogramComponent::SpectrogramComponent(SpectrogramVSTAudioProcessor& _audioProcessor):
+    audioProcessor(_audioProcessor),
+    sampleRate(getSampleRateOf(_audioProcessor)),
+    maxFrequency(sampleRate / 2),
+    columnsPerSecond(240),
+    displayedNumStreams(0),
+    displayedChannelMode(AnalysisWorker::ChannelMode::perChannel),
+    displayedOverlay(false),
+    displayedColourMap(ColourMap::Type::inferno),
+    displayedFrequencyScale(FrequencyAxis::Scale::log),
+    dragStartViewEndColumn(0),
+    vBlankAttachment(this, [this] { update(); })
+{
+    // The image covers every pixel, so nothing behind needs painting first.
+    setOpaque(true);
+
+    spectrogramRenderer.setSampleRate(sampleRate);
+    spectrogramRenderer.setColumnsPerSecond(columnsPerSecond);
+    spectrogramRenderer.setFrequencyRange(minFrequency, maxFrequency);
+
+    // Throw away whatever queued up while the editor was closed.
+    for (int stream = 0; stream < audioProcessor.getNumAnalysisStreams(); stream++) {
+        auto& queue = audioProcessor.getFrameQueue(stream);
+
+        while (queue.beginRead() != nullptr) {
+            queue.finishRead();
+        }
+    }
+}
+
+SpectrogramComponent::~SpectrogramComponent() {
+    // Nobody's looking, so the analysis can stop accumulating.
+    audioProcessor.setDisplayAxis(displayedFrequencyScale, minFrequency, maxFrequency, 0);
+}
+
+void SpectrogramComponent::paint(juce::Graphics& g) {
+    // Unscaled, so the blit is clipped to the dirty columns: usually one strip, two when the write head wrapped.
+    g.drawImageAt(spectrogramRenderer.getImage(), 0, 0);
+    drawStreamNames(g);
+    drawViewInfo(g);
+}
+
+void SpectrogramComponent::resized() {
+    spectrogramRenderer.setSize(getWidth(), getHeight());
+    repaint();
+}
+
+void SpectrogramComponent::mouseDown(const juce::MouseEvent&) {
+    dragStartViewEndColumn = spectrogramRenderer.getViewEndColumn();
+}
+
+void SpectrogramComponent::mouseDrag(const juce::MouseEvent& e) {
+    // Dragging right pulls older columns into view.
+    auto columnsPerPixel = (juce::int64)1 << spectrogramRenderer.getZoomLevel();
+    auto distance = (juce::int64)e.getDistanceFromDragStartX();
+    spectrogramRenderer.setView(spectrogramRenderer.getZoomLevel(), dragStartViewEndColumn - distance * columnsPerPixel);
+}
+
+void SpectrogramComponent::mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails& wheel) {
+    if (wheel.deltaY == 0) {
+        return;
+    }
+
+    auto viewEndColumn = spectrogramRenderer.isLive() ? SpectrogramRenderer::latest : spectrogramRenderer.getViewEndColumn();
+    int zoomLevel = spectrogramRenderer.getZoomLevel() + (wheel.deltaY < 0 ? 1 : -1);
+    spectrogramRenderer.setView(zoomLevel, viewEndColumn);
+}
+
+void SpectrogramComponent::mouseDoubleClick(const juce::MouseEvent&) {
+    spectrogramRenderer.setView(0, SpectrogramRenderer::latest);
+}
+
+void SpectrogramComponent::update() {
+    bool useReassignment = audioProcessor.apvts.getRawParameterValue("Reassignment Enabled")->load();
+    bool trackPartials = audioProcessor.apvts.getRawParameterValue("Track Partials")->load();
+    bool overlay = audioProcessor.apvts.getRawParameterValue("Stream Display")->load() == 0;
+    int numStreams = audioProcessor.getNumAnalysisStreams();
+    auto channelMode = audioProcessor.getAnalysisChannelMode();
+    auto colourMap = (ColourMap::Type)(int)audioProcessor.apvts.getRawParameterValue("Colour Map")->load();
+    auto frequencyScale = (FrequencyAxis::Scale)(int)audioProcessor.apvts.getRawParameterValue("Frequency Scale")->load();
+    int scrollSpeed = juce::jlimit(0, (int)scrollSpeeds.size() - 1, (int)audioProcessor.apvts.getRawParameterValue("Scroll Speed")->load());
+
+    // Everything on screen was placed at the old rate.
+    if (getSampleRateOf(audioProcessor) != sampleRate) {
+        sampleRate = getSampleRateOf(audioProcessor);
+        spectrogramRenderer.setSampleRate(sampleRate);
+        spectrogramRenderer.clear();
+    }
+
+    // Full follows the rate.
+    int maxFrequencyIndex = juce::jlimit(0, (int)maxFrequencies.size() - 1, (int)audioProcessor.apvts.getRawParameterValue("Max Frequency")->load());
+    float wantedMaxFrequency = maxFrequencies[(size_t)maxFrequencyIndex] > 0 ? maxFrequencies[(size_t)maxFrequencyIndex] : sampleRate / 2;
+
+    if (colourMap != displayedColourMap) {
+        displayedColourMap = colourMap;
+        spectrogramRenderer.setColourMap(colourMap);
+    }
+
+    // Rows mean different frequencies on the new scale, so the old columns would be misleading.
+    if (frequencyScale != displayedFrequencyScale) {
+        displayedFrequencyScale = frequencyScale;
+        spectrogramRenderer.setFrequencyScale(frequencyScale);
+        spectrogramRenderer.clear();
+    }
+
+    // Likewise columns, which were a different length of time.
+    if (scrollSpeeds[(size_t)scrollSpeed] != columnsPerSecond) {
+        columnsPerSecond = scrollSpeeds[(size_t)scrollSpeed];
+        spectrogramRenderer.setColumnsPerSecond(columnsPerSecond);
+        spectrogramRenderer.clear();
+    }
+
+    // And rows again. The analysis restarts at its new decimation once it sees the new axis below.
+    if (wantedMaxFrequency != maxFrequency) {
+        maxFrequency = wantedMaxFrequency;
+        spectrogramRenderer.setFrequencyRange(minFrequency, maxFrequency);
+        spectrogramRenderer.clear();
+    }
+
+    if (numStreams != displayedNumStreams || channelMode != displayedChannelMode || overlay != displayedOverlay) {
+        displayedNumStreams = numStreams;
+        displayedChannelMode = channelMode;
+        displayedOverlay = overlay;
+        spectrogramRenderer.setStreamLayout(numStreams, overlay);
+        spectrogramRenderer.clear();
+
+        // The stream names moved too.
+        repaint();
+    }
+
+    spectrogramRenderer.setMagnitudeRange(audioProcessor.noiseFloorDb.load(), -14.9f);
+
+    // The reassigned points are accumulated on the analysis side, straight onto our rows. The partials are drawn
+    // instead of them, when they're tracked.
+    bool accumulate = useReassignment && !trackPartials;
+    audioProcessor.setDisplayAxis(frequencyScale, minFrequency, maxFrequency, accumulate ? spectrogramRenderer.getStreamHeight() : 0);
+
+    // The streams are analysed in parallel, so one may be a frame ahead of another. Only draw as many
+    // frames as every stream has, which keeps their columns lined up. After a stall this is the whole
+    // backlog, which the sample clock spreads over however many columns it covers.
+    int numFrames = std::numeric_limits<int>::max();
+
+    for (int stream = 0; stream < numStreams; stream++) {
+        numFrames = juce::jmin(numFrames, audioProcessor.getFrameQueue(stream).getNumReady());
+    }
+
+    if (numStreams == 0) {
+        numFrames = 0;
+    }
+
+    // Draw every frame that arrived since the last refresh, exactly once.
+    for (int stream = 0; stream < numStreams; stream++) {
+        auto& queue = audioProcessor.getFrameQueue(stream);
+
+        for (int i = 0; i < numFrames; i++) {
+            auto* frame = queue.beginRead();
+
+            if (trackPartials) {
+                spectrogramRenderer.updateSpectrogramPartials(*frame, stream);
+            }
+            else if (useReassignment) {
+                spectrogramRenderer.updateSpectrogramAccumulated(*frame, stream);
+            }
+            else {
+                spectrogramRenderer.updateSpectrogram(*frame, stream);
+            }
+
+            queue.finishRead();
+        }
+    }
+
+    spectrogramRenderer.refresh();
+
+    // A paused view doesn't change, but it does fall further behind.
+    if (!spectrogramRenderer.isLive() && numFrames > 0) {
+        repaint(getLocalBounds().removeFromBottom(18));
+    }
+
+    // Nothing new (and nothing cleared) means nothing to repaint.
+    for (auto& area : spectrogramRenderer.takeDirtyArea()) {
+        repaint(area);
+    }
+}
+
+void SpectrogramComponent::drawStreamNames(juce::Graphics& g) {
+    if (displayedNumStreams <= 1) {
+        return;
+    }
+
+    auto area = getLocalBounds();
+    g.setFont(12.f);
+
+    for (int stream = 0; stream < displayedNumStreams; stream++) {
+        auto name = audioProcessor.getAnalysisStreamName(stream);
+
+        if (displayedOverlay) {
+            // A legend along the top, in each stream's colour.
+            g.setColour(spectrogramRenderer.getStreamColour(stream));
+            g.drawText(name, area.getX() + 4 + stream * 32, area.getY() + 4, 30, 14, juce::Justification::centredLeft);
+        }
+        else {
+            int laneHeight = area.getHeight() / displayedNumStreams;
+            g.setColour(juce::Colours::white);
+            g.drawText(name, area.getX() + 4, area.getY() + stream * laneHeight + 4, 30, 14, juce::Justification::centredLeft);
+        }
+    }
+}
+
+void SpectrogramComponent::drawViewInfo(juce::Graphics& g) {
+    if (spectrogramRenderer.isLive()) {
+        return;
+    }
+
+    auto& history = spectrogramRenderer.getHistory();
+    auto columnsBack = history.getNumColumns() - 1 - spectrogramRenderer.getViewEndColumn();
+    auto secondsBack = columnsBack / columnsPerSecond;
+
+    juce::String info;
+    info << "1:" << (1 << spectrogramRenderer.getZoomLevel());
+
+    if (columnsBack > 0) {
+        info << ", " << juce::String(secondsBack, 1) << " s back";
+    }
+
+    info << " (double-click for live)";
+
+    g.setFont(12.f);
+    g.setColour(juce::Colours::white);
+    g.drawText(info, getLocalBounds().removeFromBottom(18).reduced(4), juce::Justification::centredRight);
+}
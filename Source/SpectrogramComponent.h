@@ -0,0 +1,63 @@
+#pragma once
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "SpectrogramRenderer.h"
+
+// The spectrogram in the editor. It picks up new frames once per display refresh and
+// repaints only the columns they were drawn into, so an idle or paused instance costs next to nothing.
+// The mouse wheel zooms out over the history, dragging scrolls back through it, and a double-click
+// goes back to the live view.
+class SpectrogramComponent : public juce::Component
+{
+public:
+    SpectrogramComponent(SpectrogramVSTAudioProcessor& _audioProcessor);
+    ~SpectrogramComponent() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+    void mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
+    void mouseDoubleClick(const juce::MouseEvent& e) override;
+
+private:
+    SpectrogramVSTAudioProcessor& audioProcessor;
+    SpectrogramRenderer spectrogramRenderer;
+
+    static constexpr float minFrequency = 20.f;
+
+    // The "Max Frequency" choices in Hz, 0 being the whole band. The analysis zooms in to match.
+    static constexpr std::array<float, 7> maxFrequencies { 0.f, 8000.f, 4000.f, 2000.f, 1000.f, 500.f, 250.f };
+
+    // The "Scroll Speed" choices, in pixels per second of audio.
+    static constexpr std::array<float, 5> scrollSpeeds { 60.f, 120.f, 240.f, 480.f, 960.f };
+
+    float sampleRate;
+    float maxFrequency;
+    // Frames go where the sample clock puts them at this many columns a second, however often the display refreshes.
+    float columnsPerSecond;
+
+    // What the image currently shows, so it can be cleared when the set of streams changes.
+    int displayedNumStreams;
+    AnalysisWorker::ChannelMode displayedChannelMode;
+    bool displayedOverlay;
+    ColourMap::Type displayedColourMap;
+    FrequencyAxis::Scale displayedFrequencyScale;
+
+    // Where the view ended when the current drag started.
+    juce::int64 dragStartViewEndColumn;
+
+    // Declared last, so it's gone before anything it calls into.
+    juce::VBlankAttachment vBlankAttachment;
+
+    // Draws whatever frames arrived since the last refresh and repaints the columns they touched.
+    void update();
+
+    void drawStreamNames(juce::Graphics& g);
+
+    // Zoom and how far back the view is, while it isn't live.
+    void drawViewInfo(juce::Graphics& g);
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrogramComponent)
+};
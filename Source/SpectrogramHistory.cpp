@@ -0,0 +1,175 @@
+#include "SpectrogramHistory.h"
+
+SpectrogramHistory::SpectrogramHistory():
+    numStreams(0),
+    numRows(0),
+    numLevels(0),
+    capacity(0)
+{
+    numColumns.fill(0);
+}
+
+void SpectrogramHistory::prepare(int _numStreams, int _numRows) {
+    jassert(_numStreams <= maxStreams);
+
+    numStreams = juce::jmax(0, _numStreams);
+    numRows = juce::jmax(0, _numRows);
+    levels.clear();
+    numColumns.fill(0);
+
+    if (numStreams == 0 || numRows == 0) {
+        numLevels = 0;
+        capacity = 0;
+        return;
+    }
+
+    // The largest power of two that fits, counting the pyramid, which is as big again as level 0.
+    auto columnsThatFit = (juce::int64)(maxBytes / (2 * (size_t)numStreams * (size_t)numRows));
+    capacity = 1024;
+
+    while (capacity * 2 <= columnsThatFit && capacity < maxColumns) {
+        capacity *= 2;
+    }
+
+    numLevels = juce::findHighestSetBit((juce::uint32)capacity) + 1;
+
+    for (int stream = 0; stream < numStreams; stream++) {
+        for (int level = 0; level < numLevels; level++) {
+            levels.emplace_back((size_t)((capacity >> level) * numRows), (juce::uint8)0);
+        }
+    }
+}
+
+void SpectrogramHistory::clear() {
+    for (auto& level : levels) {
+        std::fill(level.begin(), level.end(), (juce::uint8)0);
+    }
+
+    numColumns.fill(0);
+}
+
+void SpectrogramHistory::addColumn(int stream, const float* magnitudesDb) {
+    if (stream >= numStreams) {
+        return;
+    }
+
+    auto column = numColumns[(size_t)stream]++;
+    auto& fullResolution = levels[(size_t)(stream * numLevels)];
+    auto* quantised = fullResolution.data() + (size_t)((column & (capacity - 1)) * numRows);
+
+    for (int row = 0; row < numRows; row++) {
+        quantised[row] = quantise(magnitudesDb[row]);
+    }
+
+    for (int level = 1; level < numLevels; level++) {
+        auto& coarse = levels[(size_t)(stream * numLevels + level)];
+        auto coarseColumn = column >> level;
+        auto* destination = coarse.data() + (size_t)((coarseColumn & ((capacity >> level) - 1)) * numRows);
+
+        // The first column of a run starts the coarse column off, the rest only raise it.
+        if ((column & ((juce::int64)1 << level) - 1) == 0) {
+            std::copy(quantised, quantised + numRows, destination);
+        }
+        else {
+            for (int row = 0; row < numRows; row++) {
+                destination[row] = juce::jmax(destination[row], quantised[row]);
+            }
+        }
+    }
+}
+
+void SpectrogramHistory::skipColumns(int stream, juce::int64 numToSkip) {
+    if (stream >= numStreams || numToSkip <= 0) {
+        return;
+    }
+
+    auto first = numColumns[(size_t)stream];
+    auto last = first + numToSkip - 1;
+    numColumns[(size_t)stream] += numToSkip;
+
+    for (int level = 0; level < numLevels; level++) {
+        auto& ring = levels[(size_t)(stream * numLevels + level)];
+        auto levelCapacity = capacity >> level;
+
+        // A coarse column that started before the gap keeps its maximum, blanks can't raise it. One that starts
+        // inside the gap is blanked, the way addColumn() would start it off.
+        auto firstStarted = (first + ((juce::int64)1 << level) - 1) >> level;
+        auto lastStarted = last >> level;
+        auto numToBlank = juce::jmin(lastStarted - firstStarted + 1, levelCapacity);
+
+        for (auto column = lastStarted - numToBlank + 1; column <= lastStarted; column++) {
+            auto* destination = ring.data() + (size_t)((column & (levelCapacity - 1)) * numRows);
+            std::fill(destination, destination + numRows, (juce::uint8)0);
+        }
+    }
+}
+
+void SpectrogramHistory::raiseNewestColumn(int stream, const float* magnitudesDb) {
+    if (stream >= numStreams || numColumns[(size_t)stream] == 0) {
+        return;
+    }
+
+    auto column = numColumns[(size_t)stream] - 1;
+    auto& fullResolution = levels[(size_t)(stream * numLevels)];
+    auto* quantised = fullResolution.data() + (size_t)((column & (capacity - 1)) * numRows);
+
+    for (int row = 0; row < numRows; row++) {
+        quantised[row] = juce::jmax(quantised[row], quantise(magnitudesDb[row]));
+    }
+
+    // Raising only ever raises the maximum, so the coarse columns just take the new values in.
+    for (int level = 1; level < numLevels; level++) {
+        auto& coarse = levels[(size_t)(stream * numLevels + level)];
+        auto* destination = coarse.data() + (size_t)(((column >> level) & ((capacity >> level) - 1)) * numRows);
+
+        for (int row = 0; row < numRows; row++) {
+            destination[row] = juce::jmax(destination[row], quantised[row]);
+        }
+    }
+}
+
+int SpectrogramHistory::getNumStreams() const {
+    return numStreams;
+}
+
+int SpectrogramHistory::getNumRows() const {
+    return numRows;
+}
+
+int SpectrogramHistory::getNumLevels() const {
+    return numLevels;
+}
+
+juce::int64 SpectrogramHistory::getNumColumns() const {
+    return numColumns[0];
+}
+
+juce::int64 SpectrogramHistory::getCapacity() const {
+    return capacity;
+}
+
+bool SpectrogramHistory::hasColumn(int level, juce::int64 column) const {
+    if (level < 0 || level >= numLevels || column < 0 || numColumns[0] == 0) {
+        return false;
+    }
+
+    auto newest = (numColumns[0] - 1) >> level;
+    return column <= newest && column > newest - (capacity >> level);
+}
+
+const juce::uint8* SpectrogramHistory::getColumn(int stream, int level, juce::int64 column) const {
+    jassert(hasColumn(level, column));
+
+    auto& ring = levels[(size_t)(stream * numLevels + level)];
+    return ring.data() + (size_t)((column & ((capacity >> level) - 1)) * numRows);
+}
+
+juce::uint8 SpectrogramHistory::quantise(float magnitudeDb) {
+    // Written so NaN ends up at the bottom too.
+    float steps = (magnitudeDb - minDb) / dbPerStep;
+    return steps > 0.f ? (juce::uint8)juce::jmin(255.f, steps + 0.5f) : (juce::uint8)0;
+}
+
+float SpectrogramHistory::toDecibels(juce::uint8 quantised) {
+    return minDb + quantised * dbPerStep;
+}
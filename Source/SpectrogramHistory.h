@@ -0,0 +1,65 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Minutes of drawn columns, kept as dB quantised to a byte per row so they can be recoloured or redrawn at
+// any zoom without analysing anything again.
+// Every stream has a ring of columns plus a pyramid of coarser levels, level L holding the maximum of each
+// run of 2^L columns, so drawing any stretch of the history costs one column per pixel however far out it's zoomed.
+// Coarse columns are built up as their columns arrive, so the newest one is always current.
+class SpectrogramHistory
+{
+public:
+    static constexpr int maxStreams = 8;
+    static constexpr juce::int64 maxColumns = 1 << 20;
+    static constexpr float minDb = -100.f;
+    static constexpr float dbPerStep = 0.5f;
+
+    // Shared between the streams, so side by side streams (fewer rows each) get as much time as one.
+    static constexpr size_t maxBytes = 64 << 20;
+
+    SpectrogramHistory();
+
+    // Not real-time safe. Sizes the rings for this many streams of numRows rows each, and empties them.
+    void prepare(int _numStreams, int _numRows);
+
+    void clear();
+
+    // magnitudesDb has numRows values, row 0 at the bottom. Streams are expected to add their columns in step.
+    void addColumn(int stream, const float* magnitudesDb);
+
+    // Adds numToSkip blank columns, without touching more of the rings than they hold, so a long gap still moves
+    // the stream on by as many columns as time passed.
+    void skipColumns(int stream, juce::int64 numToSkip);
+
+    // Raises the stream's newest column to at least these values, for when several frames share a column.
+    void raiseNewestColumn(int stream, const float* magnitudesDb);
+
+    int getNumStreams() const;
+    int getNumRows() const;
+    int getNumLevels() const;
+
+    // Columns added so far (by stream 0), and how many of the newest ones are still kept.
+    juce::int64 getNumColumns() const;
+    juce::int64 getCapacity() const;
+
+    // Whether the given column of a level (which covers columns column * 2^level to (column + 1) * 2^level - 1)
+    // is still held.
+    bool hasColumn(int level, juce::int64 column) const;
+
+    const juce::uint8* getColumn(int stream, int level, juce::int64 column) const;
+
+    static juce::uint8 quantise(float magnitudeDb);
+    static float toDecibels(juce::uint8 quantised);
+
+private:
+    int numStreams;
+    int numRows;
+    int numLevels;
+    juce::int64 capacity;
+    std::array<juce::int64, maxStreams> numColumns;
+
+    // levels[stream * numLevels + level] is a ring of capacity >> level columns of numRows bytes.
+    std::vector<std::vector<juce::uint8>> levels;
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrogramHistory)
+};
@@ -0,0 +1,602 @@
+#include "SpectrogramRenderer.h"
+
+SpectrogramRenderer::SpectrogramRenderer():
+    sampleRate(48000),
+    columnsPerSecond(240),
+    minMagnitudeDb(-96.f),
+    maxMagnitudeDb(-14.9f),
+    minFrequency(20.f),
+    maxFrequency(24000.f),
+    frequencyScale(FrequencyAxis::Scale::log),
+    numStreams(1),
+    overlay(false),
+    zoomLevel(0),
+    viewEndColumn(latest),
+    drawnViewEndColumn(0),
+    needsRedraw(false)
+{
+    streamImagePositions.fill(0);
+    newestColumns.fill(noColumn);
+
+    // Distinct hues for overlaid streams, in channel order (L, R, C, LFE, Ls, Rs, ...).
+    streamColours = {
+        juce::Colour::fromRGB(255, 80, 64),
+        juce::Colour::fromRGB(64, 192, 255),
+        juce::Colour::fromRGB(96, 255, 96),
+        juce::Colour::fromRGB(255, 208, 64),
+        juce::Colour::fromRGB(192, 96, 255),
+        juce::Colour::fromRGB(255, 96, 192),
+        juce::Colour::fromRGB(96, 255, 208),
+        juce::Colour::fromRGB(255, 255, 255)
+    };
+
+    for (int stream = 0; stream < maxStreams; stream++) {
+        for (int i = 0; i < colourTableSize; i++) {
+            streamColourTables[stream][i] = streamColours[stream].withMultipliedBrightness(i / (float)(colourTableSize - 1)).getPixelARGB();
+        }
+    }
+
+    setColourMap(ColourMap::Type::inferno);
+}
+
+void SpectrogramRenderer::setSize(int width, int height) {
+    // A software image, so its pixels can always be written in place (a native one may be ARGB, or live elsewhere).
+    image = juce::Image(juce::Image::RGB, width, height, true, juce::SoftwareImageType());
+    largestMagnitudeForY.assign((size_t)height, 0.f);
+    columnDb.assign((size_t)height, SpectrogramHistory::minDb);
+    blankColumnDb.assign((size_t)height, SpectrogramHistory::minDb);
+    newestColumnDb.assign((size_t)(maxStreams * height), SpectrogramHistory::minDb);
+    dirtyColumns.assign((size_t)width, true);
+    resetColumns();
+    history.prepare(numStreams, getStreamHeight());
+    zoomLevel = 0;
+    viewEndColumn = latest;
+}
+
+void SpectrogramRenderer::setSampleRate(float _sampleRate) {
+    sampleRate = _sampleRate;
+}
+
+void SpectrogramRenderer::setColumnsPerSecond(float _columnsPerSecond) {
+    columnsPerSecond = _columnsPerSecond;
+    newestColumns.fill(noColumn);
+}
+
+void SpectrogramRenderer::setMagnitudeRange(float _minMagnitudeDb, float _maxMagnitudeDb) {
+    if (_minMagnitudeDb == minMagnitudeDb && _maxMagnitudeDb == maxMagnitudeDb) {
+        return;
+    }
+
+    minMagnitudeDb = _minMagnitudeDb;
+    maxMagnitudeDb = _maxMagnitudeDb;
+    needsRedraw = true;
+}
+
+void SpectrogramRenderer::setFrequencyRange(float _minFrequency, float _maxFrequency) {
+    minFrequency = _minFrequency;
+    maxFrequency = _maxFrequency;
+}
+
+void SpectrogramRenderer::setFrequencyScale(FrequencyAxis::Scale _frequencyScale) {
+    frequencyScale = _frequencyScale;
+}
+
+void SpectrogramRenderer::setStreamLayout(int _numStreams, bool _overlay) {
+    jassert(_numStreams <= maxStreams);
+
+    numStreams = _numStreams;
+    overlay = _overlay;
+    resetColumns();
+    history.prepare(numStreams, getStreamHeight());
+    zoomLevel = 0;
+    viewEndColumn = latest;
+}
+
+void SpectrogramRenderer::setColourMap(ColourMap::Type _colourMap) {
+    ColourMap::get(_colourMap).createLookupTable(colourTable.data(), colourTableSize);
+    needsRedraw = true;
+}
+
+void SpectrogramRenderer::clear() {
+    if (image.isValid()) {
+        image.clear(image.getBounds());
+    }
+
+    std::fill(dirtyColumns.begin(), dirtyColumns.end(), true);
+    resetColumns();
+    history.clear();
+    zoomLevel = 0;
+    viewEndColumn = latest;
+}
+
+void SpectrogramRenderer::updateSpectrogram(const SpectralFrame& frame, int stream) {
+    // Display the spectral frame using only the FFT result.
+    auto area = getStreamArea(stream);
+    int spectrogramHeight = area.getHeight();
+    int spectrogramWidth = area.getWidth();
+
+    if (spectrogramHeight == 0 || spectrogramWidth == 0) {
+        return;
+    }
+
+    // Decimated frames cover decimation times as many input samples, at bins that much narrower.
+    int windowSize = frame.fftSize * frame.decimation;
+    frequencyAxis.update(frequencyScale, minFrequency, maxFrequency, spectrogramHeight, frame.fftSize, frame.sampleRate / frame.decimation);
+    std::fill(columnDb.begin(), columnDb.begin() + spectrogramHeight, SpectrogramHistory::minDb);
+
+    for (int i = 0; i < frame.numBins; i++) {
+        // Several high bins share a row on a log axis, only the first one gets it.
+        for (int y = frequencyAxis.getBinRowStart(i); y < frequencyAxis.getBinRowEnd(i); y++) {
+            columnDb[(size_t)y] = frame.standardFFTResult[i];
+        }
+    }
+
+    placeColumn(stream, frame.samplePosition - windowSize / 2, windowSize, columnDb.data());
+}
+
+void SpectrogramRenderer::updateSpectrogramReassigned(const SpectralFrame& frame, int stream) {
+    // Define the height and width of this stream's part of the spectrogram image
+    auto area = getStreamArea(stream);
+    int spectrogramHeight = area.getHeight();
+    int spectrogramWidth = area.getWidth();
+
+    if (spectrogramHeight == 0 || spectrogramWidth == 0) {
+        return;
+    }
+
+    int x;
+    int y;
+
+    int windowSize = frame.fftSize * frame.decimation;
+    frequencyAxis.update(frequencyScale, minFrequency, maxFrequency, spectrogramHeight, frame.fftSize, frame.sampleRate / frame.decimation);
+
+    std::fill(largestMagnitudeForY.begin(), largestMagnitudeForY.begin() + spectrogramHeight, 0.f);
+    std::fill(columnDb.begin(), columnDb.begin() + spectrogramHeight, SpectrogramHistory::minDb);
+
+    // The history has no time offsets, so every point goes into this frame's column.
+    for (int i = 0; i < frame.numPoints; i++) {
+        int row = frequencyAxis.getRow(frame.frequencies[i]);
+
+        if (row >= 0 && row < spectrogramHeight) {
+            columnDb[(size_t)row] = juce::jmax(columnDb[(size_t)row], frame.magnitudes[i]);
+        }
+    }
+
+    // Live, the points are plotted where their time offsets put them instead.
+    int frameX = placeColumn(stream, frame.samplePosition - windowSize / 2, windowSize, columnDb.data(), false);
+
+    if (!isLive()) {
+        return;
+    }
+
+    juce::Image::BitmapData pixels(image, area.getX(), area.getY(), spectrogramWidth, spectrogramHeight, juce::Image::BitmapData::readWrite);
+
+    // Draw the new stuff
+    for (int i = 0; i < frame.numPoints; i++) {
+        x = frameX + frame.times[i] * columnsPerSecond;
+        x %= spectrogramWidth;
+        int row = frequencyAxis.getRow(frame.frequencies[i]);
+        y = spectrogramHeight - 1 - row;
+
+        if (row >= 0 && x >= 0 && x < spectrogramWidth && y >= 0 && y < spectrogramHeight)
+        {
+            float magnitude = juce::jlimit(minMagnitudeDb, maxMagnitudeDb, frame.magnitudes[i]);
+            float normalizedMagnitude = juce::jmap<float>(magnitude, minMagnitudeDb, maxMagnitudeDb, 0.0f, 1.0f);
+
+            if (normalizedMagnitude > 0 && normalizedMagnitude > largestMagnitudeForY[y]) {
+                plotPixel(pixels, x, y, stream, getColourIndex(normalizedMagnitude));
+                largestMagnitudeForY[y] = normalizedMagnitude;
+                dirtyColumns[(size_t)x] = true;
+            }
+        }
+    }
+}
+
+void SpectrogramRenderer::updateSpectrogramAccumulated(const SpectralFrame& frame, int stream) {
+    int spectrogramHeight = getStreamArea(stream).getHeight();
+
+    if (frame.numAccumulatedRows != spectrogramHeight) {
+        updateSpectrogramReassigned(frame, stream);
+        return;
+    }
+
+    placeColumn(stream, frame.accumulatedSamplePosition, frame.fftSize * frame.decimation, frame.accumulated.data());
+}
+
+void SpectrogramRenderer::updateSpectrogramPartials(const SpectralFrame& frame, int stream) {
+    auto area = getStreamArea(stream);
+    int spectrogramHeight = area.getHeight();
+    int spectrogramWidth = area.getWidth();
+
+    if (spectrogramHeight == 0 || spectrogramWidth == 0) {
+        return;
+    }
+
+    int windowSize = frame.fftSize * frame.decimation;
+    frequencyAxis.update(frequencyScale, minFrequency, maxFrequency, spectrogramHeight, frame.fftSize, frame.sampleRate / frame.decimation);
+
+    std::fill(columnDb.begin(), columnDb.begin() + spectrogramHeight, SpectrogramHistory::minDb);
+
+    // Segments with an end off the axis are left out, there's nowhere to draw that end.
+    for (int i = 0; i < frame.numPartialSegments; i++) {
+        const auto& segment = frame.partialSegments[(size_t)i];
+        int startRow = frequencyAxis.getRow(segment.startFrequency);
+        int endRow = frequencyAxis.getRow(segment.endFrequency);
+
+        if (startRow < 0 || endRow < 0) {
+            continue;
+        }
+
+        for (int row = juce::jmin(startRow, endRow); row <= juce::jmax(startRow, endRow); row++) {
+            columnDb[(size_t)row] = juce::jmax(columnDb[(size_t)row], segment.magnitude);
+        }
+    }
+
+    int frameX = placeColumn(stream, frame.samplePosition - windowSize / 2, windowSize, columnDb.data(), false);
+
+    if (!isLive()) {
+        return;
+    }
+
+    juce::Image::BitmapData pixels(image, area.getX(), area.getY(), spectrogramWidth, spectrogramHeight, juce::Image::BitmapData::readWrite);
+
+    for (int i = 0; i < frame.numPartialSegments; i++) {
+        const auto& segment = frame.partialSegments[(size_t)i];
+        float startRow = frequencyAxis.getRowPosition(segment.startFrequency);
+        float endRow = frequencyAxis.getRowPosition(segment.endFrequency);
+        float startX = frameX + segment.startTime * columnsPerSecond;
+        float endX = frameX + segment.endTime * columnsPerSecond;
+
+        // A segment wider than the image would wrap onto itself.
+        if (startRow < 0 || endRow < 0 || std::abs(endX - startX) >= spectrogramWidth) {
+            continue;
+        }
+
+        float magnitude = juce::jlimit(minMagnitudeDb, maxMagnitudeDb, segment.magnitude);
+        float normalizedMagnitude = juce::jmap<float>(magnitude, minMagnitudeDb, maxMagnitudeDb, 0.0f, 1.0f);
+
+        // Row r's centre is at r + 0.5, which is pixel spectrogramHeight - 1 - r.
+        drawLine(pixels, startX, spectrogramHeight - 0.5f - startRow, endX, spectrogramHeight - 0.5f - endRow, stream, normalizedMagnitude);
+    }
+}
+
+void SpectrogramRenderer::setView(int _zoomLevel, juce::int64 _viewEndColumn) {
+    _zoomLevel = juce::jlimit(0, getMaxZoomLevel(), _zoomLevel);
+
+    // Scrolling past the newest column is the same as following it.
+    if (_viewEndColumn >= history.getNumColumns() - 1) {
+        _viewEndColumn = latest;
+    }
+
+    if (_viewEndColumn != latest) {
+        auto oldest = history.getNumColumns() - history.getCapacity();
+        _viewEndColumn = juce::jmax(_viewEndColumn, oldest + ((juce::int64)image.getWidth() << _zoomLevel));
+        _viewEndColumn = juce::jmax<juce::int64>(0, _viewEndColumn);
+    }
+
+    if (_zoomLevel == zoomLevel && _viewEndColumn == viewEndColumn) {
+        return;
+    }
+
+    zoomLevel = _zoomLevel;
+    viewEndColumn = _viewEndColumn;
+    needsRedraw = true;
+}
+
+bool SpectrogramRenderer::isLive() const {
+    return zoomLevel == 0 && viewEndColumn == latest;
+}
+
+int SpectrogramRenderer::getZoomLevel() const {
+    return zoomLevel;
+}
+
+int SpectrogramRenderer::getMaxZoomLevel() const {
+    return juce::jmax(0, history.getNumLevels() - 1);
+}
+
+juce::int64 SpectrogramRenderer::getViewEndColumn() const {
+    return viewEndColumn == latest ? history.getNumColumns() - 1 : viewEndColumn;
+}
+
+const SpectrogramHistory& SpectrogramRenderer::getHistory() const {
+    return history;
+}
+
+void SpectrogramRenderer::refresh() {
+    // Zoomed out but following the newest column, the view moves on whenever a new coarse column starts.
+    if (!isLive() && viewEndColumn == latest && (getViewEndColumn() >> zoomLevel) != drawnViewEndColumn) {
+        needsRedraw = true;
+    }
+
+    if (needsRedraw) {
+        redraw();
+    }
+}
+
+int SpectrogramRenderer::getStreamHeight() const {
+    return getStreamArea(0).getHeight();
+}
+
+const juce::Image& SpectrogramRenderer::getImage() const {
+    return image;
+}
+
+juce::RectangleList<int> SpectrogramRenderer::takeDirtyArea() {
+    juce::RectangleList<int> dirtyArea;
+    int width = (int)dirtyColumns.size();
+    int x = 0;
+
+    while (x < width) {
+        if (!dirtyColumns[(size_t)x]) {
+            x++;
+            continue;
+        }
+
+        int start = x;
+
+        while (x < width && dirtyColumns[(size_t)x]) {
+            dirtyColumns[(size_t)x] = false;
+            x++;
+        }
+
+        dirtyArea.addWithoutMerging(juce::Rectangle<int>(start, 0, x - start, image.getHeight()));
+    }
+
+    return dirtyArea;
+}
+
+juce::Colour SpectrogramRenderer::getStreamColour(int stream) const {
+    return streamColours[stream];
+}
+
+juce::Rectangle<int> SpectrogramRenderer::getStreamArea(int stream) const {
+    auto area = image.getBounds();
+
+    if (overlay || numStreams <= 1) {
+        return area;
+    }
+
+    int laneHeight = area.getHeight() / numStreams;
+    return area.withY(stream * laneHeight).withHeight(laneHeight);
+}
+
+int SpectrogramRenderer::getColourIndex(float normalizedMagnitude) {
+    return juce::jlimit(0, colourTableSize - 1, juce::roundToInt(normalizedMagnitude * (colourTableSize - 1)));
+}
+
+void SpectrogramRenderer::plotPixel(juce::Image::BitmapData& pixels, int x, int y, int stream, int colourIndex) {
+    if (!overlay || numStreams <= 1) {
+        reinterpret_cast<juce::PixelRGB*>(pixels.getPixelPointer(x, y))->set(colourTable[colourIndex]);
+        return;
+    }
+
+    lightenPixel(pixels, x, y, stream, colourIndex);
+}
+
+void SpectrogramRenderer::lightenPixel(juce::Image::BitmapData& pixels, int x, int y, int stream, int colourIndex) {
+    auto* pixel = reinterpret_cast<juce::PixelRGB*>(pixels.getPixelPointer(x, y));
+    auto& colour = overlay && numStreams > 1 ? streamColourTables[stream][colourIndex] : colourTable[colourIndex];
+
+    pixel->setARGB(
+        255,
+        juce::jmax(pixel->getRed(), colour.getRed()),
+        juce::jmax(pixel->getGreen(), colour.getGreen()),
+        juce::jmax(pixel->getBlue(), colour.getBlue())
+    );
+}
+
+void SpectrogramRenderer::drawLine(juce::Image::BitmapData& pixels, float x0, float y0, float x1, float y1, int stream, float normalizedMagnitude) {
+    // Steps along whichever axis the line is longer in, splitting each step between the two pixels it passes.
+    bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+
+    if (steep) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    float gradient = x1 > x0 ? (y1 - y0) / (x1 - x0) : 0.f;
+
+    auto plot = [&](int major, int minor, float coverage) {
+        int x = steep ? minor : major;
+        int y = steep ? major : minor;
+        int colourIndex = getColourIndex(normalizedMagnitude * coverage);
+
+        if (y < 0 || y >= pixels.height || colourIndex == 0) {
+            return;
+        }
+
+        x = ((x % pixels.width) + pixels.width) % pixels.width;
+        lightenPixel(pixels, x, y, stream, colourIndex);
+        dirtyColumns[(size_t)x] = true;
+    };
+
+    for (int major = juce::roundToInt(x0); major <= juce::roundToInt(x1); major++) {
+        float minor = y0 + gradient * (major - x0);
+        int below = (int)std::floor(minor);
+        float fraction = minor - below;
+
+        plot(major, below, 1.f - fraction);
+        plot(major, below + 1, fraction);
+    }
+}
+
+void SpectrogramRenderer::clearColumn(juce::Image::BitmapData& pixels, int x) {
+    jassert(pixels.pixelFormat == juce::Image::RGB);
+
+    // Blended streams need black to start from, otherwise the background is the bottom of the colour map.
+    auto background = overlay && numStreams > 1 ? juce::PixelARGB(255, 0, 0, 0) : colourTable[0];
+    auto* pixel = pixels.getPixelPointer(x, 0);
+
+    for (int y = 0; y < pixels.height; y++) {
+        reinterpret_cast<juce::PixelRGB*>(pixel)->set(background);
+        pixel += pixels.lineStride;
+    }
+}
+
+int SpectrogramRenderer::placeColumn(int stream, juce::int64 centreSample, int fftSize, const float* magnitudesDb, bool draw) {
+    int height = getStreamHeight();
+    int width = image.getWidth();
+    auto column = (juce::int64)std::floor((double)centreSample * columnsPerSecond / sampleRate);
+    auto& newestColumn = newestColumns[(size_t)stream];
+    float* newestDb = newestColumnDb.data() + (size_t)(stream * height);
+
+    // Frames faster than columns share them, each row keeping the loudest.
+    if (newestColumn != noColumn && column == newestColumn) {
+        for (int row = 0; row < height; row++) {
+            newestDb[row] = juce::jmax(newestDb[row], magnitudesDb[row]);
+        }
+
+        history.raiseNewestColumn(stream, newestDb);
+        int x = (streamImagePositions[stream] + width - 1) % width;
+
+        if (draw) {
+            drawLiveColumn(stream, x, newestDb);
+        }
+
+        return x;
+    }
+
+    // Frames slower than columns are held until the next one. A longer gap means frames were dropped. Only an
+    // image's worth of it is drawn, the rest would only scroll out of view again, but the history still moves
+    // on by all of it so its columns stay on the sample clock.
+    if (newestColumn != noColumn && column > newestColumn) {
+        auto numSkipped = column - newestColumn - 1;
+        auto numHeld = juce::jmin(numSkipped, (juce::int64)std::ceil(fftSize * 0.5 * columnsPerSecond / sampleRate));
+        auto numBlank = numSkipped - numHeld;
+        auto numBlankDrawn = juce::jmin(numBlank, (juce::int64)width);
+
+        for (juce::int64 i = 0; i < numHeld; i++) {
+            addColumn(stream, newestDb);
+        }
+
+        history.skipColumns(stream, numBlank - numBlankDrawn);
+
+        for (juce::int64 i = 0; i < numBlankDrawn; i++) {
+            addColumn(stream, blankColumnDb.data());
+        }
+    }
+
+    // Otherwise it's the stream's first frame, or the clock went back (playback was prepared again),
+    // and the stream carries on from here.
+    std::copy(magnitudesDb, magnitudesDb + height, newestDb);
+    newestColumn = column;
+
+    int x = streamImagePositions[stream];
+    addColumn(stream, newestDb, draw);
+    return x;
+}
+
+void SpectrogramRenderer::resetColumns() {
+    streamImagePositions.fill(0);
+    newestColumns.fill(noColumn);
+}
+
+void SpectrogramRenderer::addColumn(int stream, const float* magnitudesDb, bool draw) {
+    int& spectrogramImagePos = streamImagePositions[stream];
+
+    history.addColumn(stream, magnitudesDb);
+
+    // Otherwise the view is drawn from the history, in refresh().
+    drawLiveColumn(stream, spectrogramImagePos, draw ? magnitudesDb : nullptr);
+
+    spectrogramImagePos += 1;
+
+    if (spectrogramImagePos >= getStreamArea(stream).getWidth()) {
+        spectrogramImagePos = 0;
+    }
+}
+
+void SpectrogramRenderer::drawLiveColumn(int stream, int x, const float* magnitudesDb) {
+    if (!isLive()) {
+        return;
+    }
+
+    auto area = getStreamArea(stream);
+    juce::Image::BitmapData pixels(image, area.getX(), area.getY(), area.getWidth(), area.getHeight(), juce::Image::BitmapData::readWrite);
+
+    if (magnitudesDb != nullptr) {
+        drawColumn(pixels, x, stream, magnitudesDb);
+    }
+    else if (!overlay || stream == 0) {
+        clearColumn(pixels, x);
+    }
+
+    dirtyColumns[(size_t)x] = true;
+}
+
+void SpectrogramRenderer::drawColumn(juce::Image::BitmapData& pixels, int x, int stream, const float* magnitudesDb) {
+    // Overlaid streams blend into the column, so the first one has to start it off black.
+    if (!overlay || stream == 0) {
+        clearColumn(pixels, x);
+    }
+
+    for (int row = 0; row < pixels.height; row++) {
+        float magnitude = juce::jlimit(minMagnitudeDb, maxMagnitudeDb, magnitudesDb[row]);
+        float normalizedMagnitude = juce::jmap<float>(magnitude, minMagnitudeDb, maxMagnitudeDb, 0.0f, 1.0f);
+
+        if (normalizedMagnitude > 0) {
+            plotPixel(pixels, x, pixels.height - 1 - row, stream, getColourIndex(normalizedMagnitude));
+        }
+    }
+}
+
+void SpectrogramRenderer::redraw() {
+    needsRedraw = false;
+
+    int width = image.getWidth();
+
+    if (width == 0 || history.getNumRows() == 0) {
+        return;
+    }
+
+    // Every quantised level's colour, or -1 for the ones below the noise floor.
+    std::array<int, 256> colourIndexForLevel;
+
+    for (int level = 0; level < 256; level++) {
+        float magnitude = juce::jlimit(minMagnitudeDb, maxMagnitudeDb, SpectrogramHistory::toDecibels((juce::uint8)level));
+        float normalizedMagnitude = juce::jmap<float>(magnitude, minMagnitudeDb, maxMagnitudeDb, 0.0f, 1.0f);
+        colourIndexForLevel[(size_t)level] = normalizedMagnitude > 0 ? getColourIndex(normalizedMagnitude) : -1;
+    }
+
+    // Live, the newest column is just left of the write head and older ones wrap around behind it.
+    // Otherwise the view ends at the right edge, one (possibly coarse) column per pixel.
+    auto viewEnd = getViewEndColumn() >> zoomLevel;
+    int writePosition = streamImagePositions[0];
+    drawnViewEndColumn = viewEnd;
+
+    for (int stream = 0; stream < numStreams; stream++) {
+        auto area = getStreamArea(stream);
+        juce::Image::BitmapData pixels(image, area.getX(), area.getY(), area.getWidth(), area.getHeight(), juce::Image::BitmapData::readWrite);
+
+        for (int x = 0; x < width; x++) {
+            int columnsBack = isLive() ? ((writePosition - 1 - x) % width + width) % width : width - 1 - x;
+            auto column = viewEnd - columnsBack;
+
+            if (!overlay || stream == 0) {
+                clearColumn(pixels, x);
+            }
+
+            if (!history.hasColumn(zoomLevel, column)) {
+                continue;
+            }
+
+            auto* levels = history.getColumn(stream, zoomLevel, column);
+
+            for (int row = 0; row < pixels.height; row++) {
+                int colourIndex = colourIndexForLevel[levels[row]];
+
+                if (colourIndex >= 0) {
+                    plotPixel(pixels, x, pixels.height - 1 - row, stream, colourIndex);
+                }
+            }
+        }
+    }
+
+    std::fill(dirtyColumns.begin(), dirtyColumns.end(), true);
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ColourMap.h"
+#include "FrequencyAxis.h"
+#include "SpectralFrame.h"
+#include "SpectrogramHistory.h"
+
+// Draws analysed frames into a scrolling spectrogram image, each stream's frames placed on the sample clock.
+// It only knows about frames and an image, so it can be driven off-screen too (see Tools/SpectrogramBenchmark).
+// Every column also goes into a SpectrogramHistory, which the image is redrawn from when zoomed out, scrolled
+// back, or when the colours change.
+class SpectrogramRenderer
+{
+public:
+    static constexpr int maxStreams = 8;
+    static constexpr int colourTableSize = 1024;
+
+    // A view end column that follows the newest one.
+    static constexpr juce::int64 latest = -1;
+
+    SpectrogramRenderer();
+
+    // Creates a blank image of the given size, starts every stream back at the left edge and empties the history.
+    void setSize(int width, int height);
+
+    // What the frames' sample positions count at, for placing columns. Their bins come with their own rate.
+    void setSampleRate(float _sampleRate);
+
+    // Columns per second of audio. A frame goes in the column its window is centred on, frames that share a
+    // column are combined, and columns between frames show the frame before for up to half its window (so
+    // dropped frames leave a gap). Clear the image after changing it, the old columns were on another scale.
+    void setColumnsPerSecond(float _columnsPerSecond);
+
+    void setMagnitudeRange(float _minMagnitudeDb, float _maxMagnitudeDb);
+
+    // The frequencies at the bottom and top of the image.
+    void setFrequencyRange(float _minFrequency, float _maxFrequency);
+
+    // Takes effect from the next frame. The history's rows were on the old scale, so clear() after changing it,
+    // like SpectrogramComponent does.
+    void setFrequencyScale(FrequencyAxis::Scale _frequencyScale);
+
+    // Overlaid streams share the whole image, each in its own colour, otherwise each gets its own strip.
+    void setStreamLayout(int _numStreams, bool _overlay);
+
+    // Rebuilds the colour table, and the next refresh() recolours everything from the history.
+    void setColourMap(ColourMap::Type _colourMap);
+
+    // Blanks the image and the history, and goes back to the live view.
+    void clear();
+
+    void updateSpectrogram(const SpectralFrame& frame, int stream);
+
+    void updateSpectrogramReassigned(const SpectralFrame& frame, int stream);
+
+    // Draws the frame's accumulated column, which only needs colouring. Plots the points instead if the
+    // column was accumulated for a different height, e.g. just after a resize.
+    void updateSpectrogramAccumulated(const SpectralFrame& frame, int stream);
+
+    // Draws the frame's partial segments (see PartialTracker) as anti-aliased lines. The history only gets
+    // the rows each segment crosses, in the frame's column.
+    void updateSpectrogramPartials(const SpectralFrame& frame, int stream);
+
+    // Shows 2^zoomLevel columns per pixel, up to viewEndColumn at the right edge (or the newest, if latest).
+    // The live view (zoom level 0, latest) draws frames straight into the image as they arrive,
+    // anything else is drawn from the history by refresh(). Clamped to what the history still holds.
+    void setView(int _zoomLevel, juce::int64 _viewEndColumn);
+
+    bool isLive() const;
+    int getZoomLevel() const;
+    int getMaxZoomLevel() const;
+
+    // The newest column in view, in full resolution columns.
+    juce::int64 getViewEndColumn() const;
+
+    const SpectrogramHistory& getHistory() const;
+
+    // Redraws the image from the history if the view or the colours changed since the last time.
+    // Call it after drawing a batch of frames.
+    void refresh();
+
+    // The height of one stream's part of the image, which is what columns should be accumulated for.
+    int getStreamHeight() const;
+
+    const juce::Image& getImage() const;
+
+    // The columns drawn into since the last call, as full-height strips in image coordinates, so only they
+    // need repainting. A write head that wrapped past the right edge leaves two.
+    juce::RectangleList<int> takeDirtyArea();
+
+    juce::Colour getStreamColour(int stream) const;
+
+private:
+    using ColourTable = std::array<juce::PixelARGB, colourTableSize>;
+
+    juce::Image image;
+    std::array<int, maxStreams> streamImagePositions;
+    std::array<juce::Colour, maxStreams> streamColours;
+
+    // Normalised magnitude -> packed pixel, so drawing a pixel is a table lookup rather than a gradient interpolation.
+    ColourTable colourTable;
+    // Each overlaid stream's colour at every brightness.
+    std::array<ColourTable, maxStreams> streamColourTables;
+
+    std::vector<float> largestMagnitudeForY;
+    std::vector<float> columnDb;
+    std::vector<float> blankColumnDb;
+
+    // Each stream's newest column on the sample clock (noColumn before its first frame) and what's in it.
+    static constexpr juce::int64 noColumn = std::numeric_limits<juce::int64>::min();
+    std::array<juce::int64, maxStreams> newestColumns;
+    std::vector<float> newestColumnDb;
+
+    SpectrogramHistory history;
+    std::vector<bool> dirtyColumns;
+
+    // Bin -> rows and frequency -> row, for whatever the last frame's FFT size and stream height were.
+    FrequencyAxis frequencyAxis;
+
+    float sampleRate;
+    float columnsPerSecond;
+    float minMagnitudeDb;
+    float maxMagnitudeDb;
+    float minFrequency;
+    float maxFrequency;
+    FrequencyAxis::Scale frequencyScale;
+    int numStreams;
+    bool overlay;
+
+    int zoomLevel;
+    juce::int64 viewEndColumn;
+    juce::int64 drawnViewEndColumn;
+    bool needsRedraw;
+
+    // The part of the image a stream draws into: its own strip when side by side, all of it when overlaid.
+    juce::Rectangle<int> getStreamArea(int stream) const;
+
+    static int getColourIndex(float normalizedMagnitude);
+
+    // x and y are relative to the bitmap, which covers one stream's area.
+    // Overlaid streams lighten whatever is already there, a single stream (or side by side) uses the colour map.
+    void plotPixel(juce::Image::BitmapData& pixels, int x, int y, int stream, int colourIndex);
+
+    // Keeps the brighter of each channel, so a faint edge never darkens what's already there.
+    void lightenPixel(juce::Image::BitmapData& pixels, int x, int y, int stream, int colourIndex);
+
+    // Xiaolin Wu's line, from (x0, y0) to (x1, y1) in pixel centres, wrapping round the bitmap's width. Each
+    // pixel's brightness is normalizedMagnitude scaled by how much of it the line covers.
+    void drawLine(juce::Image::BitmapData& pixels, float x0, float y0, float x1, float y1, int stream, float normalizedMagnitude);
+
+    // Blanks one column of the bitmap, before a frame is drawn into it.
+    void clearColumn(juce::Image::BitmapData& pixels, int x);
+
+    // Puts the column of a frame whose window is centred on centreSample where the sample clock says, after
+    // filling in any columns since the stream's last one. Returns its x in the image. Without draw, a new column
+    // is left blank for the caller to plot into.
+    int placeColumn(int stream, juce::int64 centreSample, int fftSize, const float* magnitudesDb, bool draw = true);
+
+    void resetColumns();
+
+    // Records a column of dB on the stream's rows and, when live, draws it at the stream's write head.
+    void addColumn(int stream, const float* magnitudesDb, bool draw = true);
+
+    // When live, draws a column of dB at x, or only blanks it if magnitudesDb is null.
+    void drawLiveColumn(int stream, int x, const float* magnitudesDb);
+
+    void drawColumn(juce::Image::BitmapData& pixels, int x, int stream, const float* magnitudesDb);
+
+    void redraw();
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrogramRenderer)
+};
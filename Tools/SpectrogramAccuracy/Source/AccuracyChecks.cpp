@@ -0,0 +1,379 @@
+#include "AccuracyChecks.h"
+#include "AnalysisConfiguration.h"
+#include "FFTDataGenerator.h"
+#include "ReassignmentKernel.h"
+#include "SlidingDFT.h"
+
+using Result = AccuracyChecks::Result;
+
+static constexpr int sampleRate = 48000;
+static constexpr double floatEpsilon = std::numeric_limits<float>::epsilon();
+static constexpr double decibelsPerRelativeError = 8.68588963807; // 20 / ln(10)
+
+// Only bins at most this far below the loudest are compared. Further down the FFT's rounding is a good part of
+// what's in a bin, and its time and frequency don't mean much however they were worked out.
+static constexpr double dynamicRangeDb = 60.0;
+
+// Float epsilons of the loudest bin, per bin, that rounding in the two FFT paths can differ by. Measured they come
+// to under a fifth of this, and up to 5 times it before the derivative windows were scaled up for packing.
+static constexpr double fftRoundingTolerance = 8.0;
+
+// Float epsilons of the largest term, for the kernel's handful of multiplies and adds per output.
+static constexpr double kernelRoundingTolerance = 8.0;
+
+// Float epsilons of the value, for storing a result as a float.
+static constexpr double outputRoundingTolerance = 4.0;
+
+// What ReassignmentKernel.h and the sliding DFT's commit claim, and for the sliding DFT's times and frequencies,
+// which it didn't put a number on, a few times what's measured (up to 0.2% of the window and 0.02 bins).
+static constexpr double fastDecibelsToleranceDb = 2e-5;
+static constexpr double slidingMagnitudeToleranceDb = 0.1;
+static constexpr double slidingFrequencyToleranceBins = 0.05;
+static constexpr double slidingTimeToleranceWindows = 0.005;
+
+// The plugin's default.
+static constexpr float despecklingCutoff = 1.f;
+
+bool AccuracyChecks::Result::passed() const {
+    // NaN never compares as within.
+    return numCompared > 0 && error <= tolerance;
+}
+
+//==============================================================================
+// Keeps whichever bin came closest to its own tolerance.
+struct Comparison
+{
+    Result result;
+    double worstRatio = -1.0;
+
+    Comparison(const juce::String& check, int fftSize, const juce::String& window, const juce::String& quantity, const juce::String& unit) {
+        result.check = check;
+        result.fftSize = fftSize;
+        result.window = window;
+        result.quantity = quantity;
+        result.unit = unit;
+    }
+
+    void add(double error, double tolerance) {
+        double ratio = std::isnan(error) ? std::numeric_limits<double>::infinity() : (error == 0.0 ? 0.0 : error / tolerance);
+        result.numCompared++;
+
+        if (ratio > worstRatio) {
+            worstRatio = ratio;
+            result.error = error;
+            result.tolerance = tolerance;
+        }
+    }
+};
+
+// The reassignment of one bin the way it was first written, with complex division, in double.
+struct ReferenceBin
+{
+    double magnitude;
+    double decibels;
+    double time;
+    double frequency;
+    double mixedPartialPhaseDerivative;
+};
+
+static ReferenceBin reassign(std::complex<double> x, std::complex<double> xDh, std::complex<double> xTh,
+                             std::complex<double> xTDh, int bin, double fftBinSize) {
+    ReferenceBin reference;
+    double magnitudeSquared = std::norm(x);
+    reference.magnitude = std::sqrt(magnitudeSquared);
+    reference.decibels = magnitudeSquared > 0.0 ? juce::jmax(-100.0, 20.0 * std::log10(2.0 * reference.magnitude)) : -100.0;
+    reference.time = 0.0;
+    reference.frequency = bin * fftBinSize;
+    reference.mixedPartialPhaseDerivative = 0.0;
+
+    if (magnitudeSquared > 0.0) {
+        reference.time = std::real(xTh / x) / sampleRate;
+        reference.frequency -= std::imag(xDh / x) * sampleRate / juce::MathConstants<double>::twoPi;
+        reference.mixedPartialPhaseDerivative = std::real(xTDh * std::conj(x)) / magnitudeSquared - std::real(xTh * xDh) / magnitudeSquared;
+    }
+
+    return reference;
+}
+
+// Three steady sines, a chirp up through most of the band and noise at about -80 dB, so that every bin has
+// something in it, plus a unit impulse at impulsePosition if that's inside the signal.
+static std::vector<float> makeSignal(int numSamples, int impulsePosition) {
+    std::vector<float> signal((size_t)numSamples);
+    juce::Random random(1);
+    double twoPi = juce::MathConstants<double>::twoPi;
+
+    for (int i = 0; i < numSamples; i++) {
+        double t = i / (double)sampleRate;
+        signal[(size_t)i] = (float)(0.5 * std::sin(twoPi * 1000.3 * t)
+                                  + 0.1 * std::sin(twoPi * 12345.6 * t)
+                                  + 0.01 * std::sin(twoPi * 440.0 * t)
+                                  + 0.25 * std::sin(twoPi * (3000.0 * t + 10000.0 * t * t))
+                                  + 1e-4 * (random.nextDouble() * 2.0 - 1.0));
+    }
+
+    if (impulsePosition >= 0 && impulsePosition < numSamples) {
+        signal[(size_t)impulsePosition] += 1.f;
+    }
+
+    return signal;
+}
+
+// One of the four spectra as they were before packing: a full complex FFT of the real windowed frame,
+// scaled by 2 / fftSize, and only the positive half kept.
+static std::vector<std::complex<double>> getUnpackedSpectrum(const juce::dsp::FFT& fft, const float* input, const std::vector<float>& window) {
+    int fftSize = fft.getSize();
+    std::vector<std::complex<float>> frame((size_t)fftSize), spectrum((size_t)fftSize);
+
+    for (int i = 0; i < fftSize; i++) {
+        frame[(size_t)i] = input[i] * window[(size_t)i];
+    }
+
+    fft.perform(frame.data(), spectrum.data(), false);
+
+    std::vector<std::complex<double>> result((size_t)fftSize / 2);
+
+    for (int k = 0; k < fftSize / 2; k++) {
+        result[(size_t)k] = std::complex<double>(spectrum[(size_t)k]) * (2.0 / fftSize);
+    }
+
+    return result;
+}
+
+static juce::String getWindowName(AnalysisConfiguration::Window window) {
+    return AnalysisConfiguration::getWindowNames()[(int)window];
+}
+
+//==============================================================================
+static void checkPacking(int fftOrder, AnalysisConfiguration::Window window, std::vector<Comparison>& comparisons) {
+    AnalysisConfiguration configuration(fftOrder, window);
+    int fftSize = configuration.fftSize;
+    int numBins = fftSize / 2;
+    double fftBinSize = (double)sampleRate / fftSize;
+    auto signal = makeSignal(fftSize, -1);
+
+    // Despeckling is left to the kernel check, here it would only drop bins that are near the cutoff either way.
+    FFTDataGenerator generator(sampleRate);
+    generator.updateParameters(configuration, std::numeric_limits<float>::max());
+
+    std::vector<float> times((size_t)numBins), frequencies((size_t)numBins), magnitudes((size_t)numBins), standard((size_t)numBins);
+    generator.reassignedSpectrogram(signal.data(), times.data(), frequencies.data(), magnitudes.data(), standard.data());
+
+    juce::dsp::FFT fft(fftOrder);
+    auto x = getUnpackedSpectrum(fft, signal.data(), configuration.standardWindow);
+    auto xDh = getUnpackedSpectrum(fft, signal.data(), configuration.derivativeWindow);
+    auto xTh = getUnpackedSpectrum(fft, signal.data(), configuration.timeWeightedWindow);
+    auto xTDh = getUnpackedSpectrum(fft, signal.data(), configuration.derivativeTimeWeightedWindow);
+
+    double loudest = 0.0;
+
+    for (auto& bin : x) {
+        loudest = juce::jmax(loudest, std::abs(bin));
+    }
+
+    auto name = getWindowName(window);
+    Comparison time("packing", fftSize, name, "time", "s");
+    Comparison frequency("packing", fftSize, name, "frequency", "Hz");
+    Comparison magnitude("packing", fftSize, name, "magnitude", "dB");
+
+    for (int k = 0; k < numBins; k++) {
+        auto reference = reassign(x[(size_t)k], xDh[(size_t)k], xTh[(size_t)k], xTDh[(size_t)k], k, fftBinSize);
+
+        if (reference.magnitude < loudest * juce::Decibels::decibelsToGain(-dynamicRangeDb)) {
+            continue;
+        }
+
+        // Both FFTs round to about epsilon of the loudest bin, which is that much more of a quiet one.
+        double rounding = fftRoundingTolerance * floatEpsilon * loudest / reference.magnitude;
+
+        time.add(std::abs(times[(size_t)k] - reference.time),
+                 outputRoundingTolerance * floatEpsilon * std::abs(reference.time) + rounding * fftSize / sampleRate);
+        frequency.add(std::abs(frequencies[(size_t)k] - reference.frequency),
+                      outputRoundingTolerance * floatEpsilon * std::abs(reference.frequency) + rounding * fftBinSize);
+        magnitude.add(std::abs(magnitudes[(size_t)k] - reference.decibels),
+                      fastDecibelsToleranceDb + rounding * decibelsPerRelativeError);
+    }
+
+    comparisons.insert(comparisons.end(), { time, frequency, magnitude });
+}
+
+static void checkFastDecibels(std::vector<Comparison>& comparisons) {
+    // Powers from 1e-60 to 1e10 as in ReassignmentKernel.h. Below about 1e-45 they're 0 as floats, and below
+    // 2.5e-11 they're on the -100 dB floor, which the reference has too.
+    Comparison decibels("kernel", 0, "-", "fastDecibels", "dB");
+
+    for (int i = -60000; i < 10000; i++) {
+        float power = (float)std::pow(10.0, i / 1000.0);
+        double expected = power > 0.f ? juce::jmax(-100.0, 10.0 * std::log10(4.0 * (double)power)) : -100.0;
+        decibels.add(std::abs(ReassignmentKernel::fastDecibels(power) - expected), fastDecibelsToleranceDb);
+    }
+
+    comparisons.push_back(decibels);
+}
+
+static void checkKernel(int fftOrder, std::vector<Comparison>& comparisons) {
+    int fftSize = 1 << fftOrder;
+    float fftBinSize = (float)sampleRate / (float)fftSize;
+
+    // One short of a multiple of four, so the scalar tail runs as well as the vector body.
+    int numBins = fftSize / 2 - 1;
+
+    // Made up rather than from a signal, to reach every corner: levels from -114 to +26 dB so some bins are on the
+    // -100 dB floor, every 64th bin silent, and each spectrum about its usual size against the plain one so the
+    // mixed derivative lands either side of the cutoff.
+    std::array<std::vector<float>, 8> split;
+    std::array<double, 8> scales { 1.0, 1.0, 6.0 / fftSize, 6.0 / fftSize, fftSize / 4.0, fftSize / 4.0, 1.5, 1.5 };
+    juce::Random random(fftOrder);
+
+    for (auto& spectrum : split) {
+        spectrum.resize((size_t)numBins);
+    }
+
+    for (int k = 0; k < numBins; k++) {
+        double level = k % 64 == 0 ? 0.0 : std::pow(10.0, random.nextDouble() * 7.0 - 6.0);
+
+        for (size_t s = 0; s < split.size(); s++) {
+            split[s][(size_t)k] = (float)(level * scales[s] * (random.nextDouble() * 2.0 - 1.0));
+        }
+    }
+
+    ReassignmentSpectra spectra { split[0].data(), split[1].data(), split[2].data(), split[3].data(),
+                                  split[4].data(), split[5].data(), split[6].data(), split[7].data() };
+
+    std::vector<float> times((size_t)numBins), frequencies((size_t)numBins), magnitudes((size_t)numBins), standard((size_t)numBins);
+    ReassignmentKernel::process(spectra, numBins, (float)sampleRate, fftBinSize, despecklingCutoff,
+                                times.data(), frequencies.data(), magnitudes.data(), standard.data());
+
+    Comparison time("kernel", fftSize, "-", "time", "s");
+    Comparison frequency("kernel", fftSize, "-", "frequency", "Hz");
+    Comparison decibels("kernel", fftSize, "-", "standard", "dB");
+    Comparison magnitude("kernel", fftSize, "-", "magnitude", "dB");
+
+    for (int k = 0; k < numBins; k++) {
+        auto get = [&](int s) { return (double)split[(size_t)s][(size_t)k]; };
+        double xr = get(0), xi = get(1), dr = get(2), di = get(3), tr = get(4), ti = get(5), tdr = get(6), tdi = get(7);
+        auto reference = reassign({ xr, xi }, { dr, di }, { tr, ti }, { tdr, tdi }, k, fftBinSize);
+
+        // Each output is a short sum of products over |X|^2, so its rounding is relative to the largest term.
+        double inverse = reference.magnitude > 0.0 ? 1.0 / (reference.magnitude * reference.magnitude) : 0.0;
+        double rounding = kernelRoundingTolerance * floatEpsilon * inverse;
+        double decibelsTolerance = fastDecibelsToleranceDb + 2.0 * floatEpsilon * decibelsPerRelativeError;
+
+        time.add(std::abs(times[(size_t)k] - reference.time),
+                 rounding * (std::abs(tr * xr) + std::abs(ti * xi)) / sampleRate);
+        frequency.add(std::abs(frequencies[(size_t)k] - reference.frequency),
+                      rounding * (std::abs(dr * xi) + std::abs(di * xr)) * sampleRate / juce::MathConstants<double>::twoPi
+                          + outputRoundingTolerance * floatEpsilon * std::abs(reference.frequency));
+        decibels.add(std::abs(standard[(size_t)k] - reference.decibels), decibelsTolerance);
+
+        // Bins this close to the cutoff can go either way on rounding.
+        double mixedRounding = rounding * (std::abs(tdr * xr) + std::abs(tdi * xi) + std::abs(tr * dr) + std::abs(ti * di));
+
+        if (std::abs(std::abs(reference.mixedPartialPhaseDerivative) - despecklingCutoff) > mixedRounding) {
+            double expected = std::abs(reference.mixedPartialPhaseDerivative) > despecklingCutoff ? -100.0 : reference.decibels;
+            magnitude.add(std::abs(magnitudes[(size_t)k] - expected), decibelsTolerance);
+        }
+    }
+
+    comparisons.insert(comparisons.end(), { time, frequency, decibels, magnitude });
+}
+
+static void checkSliding(int fftOrder, AnalysisConfiguration::Window window, std::vector<Comparison>& comparisons) {
+    AnalysisConfiguration configuration(fftOrder, window);
+    int fftSize = configuration.fftSize;
+    int numBins = fftSize / 2;
+    double fftBinSize = (double)sampleRate / fftSize;
+
+    // Three and a half windows, so the last resync was half a window back and the recursion has run since.
+    // The impulse is in the last window, a third of the way from its end.
+    int numSamples = fftSize * 7 / 2;
+    auto signal = makeSignal(numSamples, numSamples - fftSize / 3);
+
+    // Only the points the analyser keeps are compared. Its windows are periodic where the FFT's are symmetric, and
+    // in the bins despeckling drops, where sines and the impulse cancel, that small difference is a big one.
+    SlidingDFT sliding(sampleRate);
+    sliding.updateParameters(&configuration, despecklingCutoff);
+
+    for (int i = 0; i < numSamples; i += SlidingDFT::maxHopSize) {
+        sliding.push(signal.data() + i, juce::jmin(SlidingDFT::maxHopSize, numSamples - i));
+    }
+
+    FFTDataGenerator generator(sampleRate);
+    generator.updateParameters(configuration, despecklingCutoff);
+
+    std::vector<float> times((size_t)numBins), frequencies((size_t)numBins), magnitudes((size_t)numBins), standard((size_t)numBins);
+    std::vector<float> fftTimes((size_t)numBins), fftFrequencies((size_t)numBins), fftMagnitudes((size_t)numBins), fftStandard((size_t)numBins);
+    sliding.reassignedSpectrogram(times.data(), frequencies.data(), magnitudes.data(), standard.data());
+    generator.reassignedSpectrogram(signal.data() + numSamples - fftSize, fftTimes.data(), fftFrequencies.data(), fftMagnitudes.data(), fftStandard.data());
+
+    float loudestDb = *std::max_element(fftStandard.begin(), fftStandard.end());
+
+    auto name = getWindowName(window);
+    Comparison time("sliding", fftSize, name, "time", "s");
+    Comparison frequency("sliding", fftSize, name, "frequency", "Hz");
+    Comparison magnitude("sliding", fftSize, name, "magnitude", "dB");
+
+    // The sliding DFT's times are from sample fftSize / 2, the FFT's from the middle of its symmetric window,
+    // half a sample later.
+    double centreOffset = 0.5 / sampleRate;
+
+    for (int k = 0; k < numBins; k++) {
+        // Bins right at the cutoff can be kept by one and not the other.
+        if (fftStandard[(size_t)k] < loudestDb - dynamicRangeDb || magnitudes[(size_t)k] <= -100.f || fftMagnitudes[(size_t)k] <= -100.f) {
+            continue;
+        }
+
+        time.add(std::abs(times[(size_t)k] - centreOffset - fftTimes[(size_t)k]), slidingTimeToleranceWindows * fftSize / sampleRate);
+        frequency.add(std::abs(frequencies[(size_t)k] - fftFrequencies[(size_t)k]), slidingFrequencyToleranceBins * fftBinSize);
+        magnitude.add(std::abs(magnitudes[(size_t)k] - fftMagnitudes[(size_t)k]), slidingMagnitudeToleranceDb);
+    }
+
+    comparisons.insert(comparisons.end(), { time, frequency, magnitude });
+}
+
+//==============================================================================
+juce::Array<Result> AccuracyChecks::run(const Settings& settings, std::function<void(const Result&)> onResult) {
+    juce::Array<Result> results;
+
+    auto report = [&](std::vector<Comparison>& comparisons) {
+        for (auto& comparison : comparisons) {
+            onResult(comparison.result);
+            results.add(comparison.result);
+        }
+
+        comparisons.clear();
+    };
+
+    std::vector<Comparison> comparisons;
+
+    if (settings.checks.contains("packing")) {
+        for (int fftOrder : settings.fftOrders) {
+            for (int window = 0; window < AnalysisConfiguration::numWindows; window++) {
+                checkPacking(fftOrder, (AnalysisConfiguration::Window)window, comparisons);
+                report(comparisons);
+            }
+        }
+    }
+
+    if (settings.checks.contains("kernel")) {
+        checkFastDecibels(comparisons);
+        report(comparisons);
+
+        for (int fftOrder : settings.fftOrders) {
+            checkKernel(fftOrder, comparisons);
+            report(comparisons);
+        }
+    }
+
+    if (settings.checks.contains("sliding")) {
+        for (int fftOrder : settings.fftOrders) {
+            for (int window = 0; window < AnalysisConfiguration::numWindows; window++) {
+                if (SlidingDFT::supports((AnalysisConfiguration::Window)window)) {
+                    checkSliding(fftOrder, (AnalysisConfiguration::Window)window, comparisons);
+                    report(comparisons);
+                }
+            }
+        }
+    }
+
+    return results;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Checks the optimised analysis paths against plain reference maths, to the accuracy they claim:
+//  - packing: FFTDataGenerator::reassignedSpectrogram, which packs two windows into each FFT, against four unpacked
+//    FFTs and the reassignment maths in double, to within float rounding
+//  - kernel: ReassignmentKernel::process against the same maths in double, with fastDecibels within 2e-5 dB
+//  - sliding: SlidingDFT::reassignedSpectrogram, well over fftSize samples in, against FFTDataGenerator on the
+//    same samples, within 0.1 dB
+// Tolerances can depend on the bin (rounding grows as a bin gets quieter), so each result is the bin that came
+// closest to its own tolerance, and anything over it is a failure.
+namespace AccuracyChecks
+{
+    const juce::StringArray allChecks { "packing", "kernel", "sliding" };
+
+    struct Settings
+    {
+        juce::Array<int> fftOrders { 10, 11, 12, 13 };
+        juce::StringArray checks = allChecks;
+    };
+
+    struct Result
+    {
+        juce::String check;
+        int fftSize = 0;
+        juce::String window;
+        juce::String quantity;
+        juce::String unit;
+
+        // At the worst bin, and how many bins were compared.
+        double error = 0.0;
+        double tolerance = 0.0;
+        int numCompared = 0;
+
+        bool passed() const;
+    };
+
+    // Calls back with each result as soon as it's done, and returns them all.
+    juce::Array<Result> run(const Settings& settings, std::function<void(const Result&)> onResult);
+}
@@ -0,0 +1,85 @@
+#include <JuceHeader.h>
+#include <iostream>
+#include "AnalysisConfiguration.h"
+#include "AccuracyChecks.h"
+
+static void printUsage() {
+    std::cout
+        << "Usage: SpectrogramAccuracy [options]\n"
+        << "\n"
+        << "Checks the optimised analysis paths against reference maths on synthetic input, and reports the\n"
+        << "worst error of each against its tolerance. Exits with 2 if anything is past its tolerance.\n"
+        << "\n"
+        << "  --fft <sizes>     comma separated, from 1024, 2048, 4096, 8192 (default all)\n"
+        << "  --checks <names>  comma separated, from packing, kernel, sliding (default all)\n";
+}
+
+int main(int argc, char* argv[]) {
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h")) {
+        printUsage();
+        return 0;
+    }
+
+    AccuracyChecks::Settings settings;
+
+    if (args.containsOption("--fft")) {
+        settings.fftOrders.clear();
+
+        for (auto& size : juce::StringArray::fromTokens(args.removeValueForOption("--fft"), ",", {})) {
+            int fftOrder = juce::roundToInt(std::log2(juce::jmax(1, size.getIntValue())));
+
+            if ((1 << fftOrder) != size.getIntValue()
+                || fftOrder < AnalysisConfigurationCache::minFFTOrder
+                || fftOrder > AnalysisConfigurationCache::maxFFTOrder) {
+                std::cerr << "--fft sizes must be 1024, 2048, 4096 or 8192\n";
+                return 1;
+            }
+
+            settings.fftOrders.add(fftOrder);
+        }
+    }
+
+    if (args.containsOption("--checks")) {
+        settings.checks.clear();
+
+        for (auto& name : juce::StringArray::fromTokens(args.removeValueForOption("--checks"), ",", {})) {
+            if (!AccuracyChecks::allChecks.contains(name)) {
+                std::cerr << "unknown check " << name << "\n";
+                return 1;
+            }
+
+            settings.checks.add(name);
+        }
+    }
+
+    std::cout << juce::String("check").paddedRight(' ', 9) << juce::String("fft").paddedLeft(' ', 6) << "  "
+              << juce::String("window").paddedRight(' ', 17) << juce::String("quantity").paddedRight(' ', 14)
+              << juce::String("bins").paddedLeft(' ', 6) << juce::String("worst error").paddedLeft(' ', 15)
+              << juce::String("tolerance").paddedLeft(' ', 15) << "\n";
+
+    int numFailures = 0;
+
+    AccuracyChecks::run(settings, [&](const AccuracyChecks::Result& result) {
+        numFailures += result.passed() ? 0 : 1;
+
+        auto format = [&](double value) {
+            return juce::String::formatted("%.3g ", value) + result.unit;
+        };
+
+        std::cout << result.check.paddedRight(' ', 9)
+                  << (result.fftSize > 0 ? juce::String(result.fftSize) : juce::String("-")).paddedLeft(' ', 6) << "  "
+                  << result.window.paddedRight(' ', 17) << result.quantity.paddedRight(' ', 14)
+                  << juce::String(result.numCompared).paddedLeft(' ', 6) << format(result.error).paddedLeft(' ', 15)
+                  << format(result.tolerance).paddedLeft(' ', 15)
+                  << (result.passed() ? "" : "  FAILED") << "\n" << std::flush;
+    });
+
+    if (numFailures > 0) {
+        std::cout << "\n" << numFailures << " past tolerance\n";
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include "BatchAnalyser.h"
+#include "ColourMap.h"
+#include "ReassignmentKernel.h"
+
+BatchAnalyser::FrameJob::FrameJob(BatchAnalyser& _analyser, const Settings& settings, double sampleRate):
+    juce::ThreadPoolJob("Batch analysis"),
+    firstFrame(0),
+    numFrames(0),
+    analyser(_analyser),
+    configuration(settings.fftOrder),
+    fftDataGenerator((int)sampleRate)
+{
+    fftDataGenerator.updateParameters(configuration, settings.despecklingCutoff);
+}
+
+juce::ThreadPoolJob::JobStatus BatchAnalyser::FrameJob::runJob() {
+    analyser.analyseFrames(fftDataGenerator, firstFrame, numFrames);
+    return jobHasFinished;
+}
+
+BatchAnalyser::BatchAnalyser(const Settings& _settings):
+    settings(_settings),
+    fftSize(1 << _settings.fftOrder),
+    // Enough frames per batch that every thread gets a decent run, without holding much of the file in memory.
+    framesPerBatch(16 * juce::jmax(1, _settings.numThreads)),
+    jobSampleRate(0),
+    frames((size_t)framesPerBatch),
+    pool(juce::jmax(1, _settings.numThreads))
+{
+    jassert(settings.fftOrder >= AnalysisConfigurationCache::minFFTOrder && settings.fftOrder <= AnalysisConfigurationCache::maxFFTOrder);
+    jassert(settings.hopSize > 0);
+
+    formatManager.registerBasicFormats();
+}
+
+BatchAnalyser::~BatchAnalyser() {
+    pool.removeAllJobs(false, 10000);
+}
+
+juce::AudioFormatManager& BatchAnalyser::getFormatManager() {
+    return formatManager;
+}
+
+juce::String BatchAnalyser::analyseFile(const juce::File& input, const juce::File& outputDirectory) {
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+    if (reader == nullptr) {
+        return "couldn't open " + input.getFullPathName() + " as audio";
+    }
+
+    if (settings.channel >= (int)reader->numChannels) {
+        return input.getFileName() + " only has " + juce::String((int)reader->numChannels) + " channels";
+    }
+
+    double sampleRate = reader->sampleRate;
+    prepareJobs(sampleRate);
+
+    // Same framing as the plugin: frame k is the fftSize samples ending at (k + 1) * hopSize,
+    // with silence before the start of the file.
+    auto numFramesInFile = (int)(reader->lengthInSamples / settings.hopSize);
+
+    if (numFramesInFile == 0) {
+        return input.getFileName() + " is shorter than one hop";
+    }
+
+    std::unique_ptr<juce::FileOutputStream> points;
+
+    if (settings.writePoints) {
+        auto pointsFile = outputDirectory.getChildFile(input.getFileNameWithoutExtension() + ".points.csv");
+        pointsFile.deleteFile();
+        points = pointsFile.createOutputStream();
+
+        if (points == nullptr) {
+            return "couldn't write to " + pointsFile.getFullPathName();
+        }
+
+        *points << "time_s,frequency_hz,magnitude_db\n";
+    }
+
+    std::unique_ptr<juce::FileOutputStream> partials;
+
+    if (settings.writePartials) {
+        auto partialsFile = outputDirectory.getChildFile(input.getFileNameWithoutExtension() + ".partials.csv");
+        partialsFile.deleteFile();
+        partials = partialsFile.createOutputStream();
+
+        if (partials == nullptr) {
+            return "couldn't write to " + partialsFile.getFullPathName();
+        }
+
+        // One line per piece of track, between two points it linked.
+        *partials << "track_id,start_s,start_hz,end_s,end_hz,magnitude_db\n";
+        partialTracker.reset();
+    }
+
+    std::unique_ptr<SpectrogramRaster> raster;
+
+    if (settings.writeImage) {
+        int width = juce::jmin(numFramesInFile, settings.maxImageWidth);
+        raster = std::make_unique<SpectrogramRaster>(
+            width,
+            settings.imageHeight,
+            (double)numFramesInFile / width,
+            20.f,
+            (float)sampleRate / 2,
+            settings.noiseFloorDb
+        );
+    }
+
+    float binSize = (float)sampleRate / fftSize;
+    float nyquist = (float)sampleRate / 2;
+    char line[128];
+
+    for (int batchStart = 0; batchStart < numFramesInFile; batchStart += framesPerBatch) {
+        int numFrames = juce::jmin(framesPerBatch, numFramesInFile - batchStart);
+        juce::int64 firstWindowStart = (juce::int64)(batchStart + 1) * settings.hopSize - fftSize;
+
+        readBatch(*reader, firstWindowStart, (numFrames - 1) * settings.hopSize + fftSize);
+        analyseBatch(numFrames);
+
+        // Written out in order on this thread, so the output doesn't depend on how the frames were scheduled.
+        for (int i = 0; i < numFrames; i++) {
+            auto& frame = frames[(size_t)i];
+            int frameIndex = batchStart + i;
+            double frameCentre = ((double)(frameIndex + 1) * settings.hopSize - fftSize / 2) / sampleRate;
+
+            for (int bin = 0; bin < frame.numBins; bin++) {
+                // Without reassignment every bin stays at its frame's centre and its own frequency.
+                float time = settings.useReassignment ? frame.times[bin] : 0.f;
+                float frequency = settings.useReassignment ? frame.frequencies[bin] : bin * binSize;
+                float magnitude = settings.useReassignment ? frame.magnitudes[bin] : frame.standardFFTResult[bin];
+
+                if (magnitude <= settings.noiseFloorDb || frequency <= 0 || frequency >= nyquist) {
+                    continue;
+                }
+
+                if (points != nullptr) {
+                    int length = std::snprintf(line, sizeof(line), "%.6f,%.3f,%.2f\n", frameCentre + time, frequency, magnitude);
+                    points->write(line, (size_t)length);
+                }
+
+                if (raster == nullptr) {
+                    continue;
+                }
+
+                if (settings.useReassignment) {
+                    raster->addPoint(frameIndex + time * sampleRate / settings.hopSize, frequency, magnitude);
+                }
+                else {
+                    raster->addBand(frameIndex, frequency, frequency + binSize, magnitude);
+                }
+            }
+
+            if (partials == nullptr) {
+                continue;
+            }
+
+            // The tracker wants the points gated like the plugin's, which packs them into the front of the frame.
+            frame.samplePosition = (juce::int64)(frameIndex + 1) * settings.hopSize;
+            frame.sampleRate = (float)sampleRate;
+            frame.decimation = 1;
+            frame.numPoints = ReassignmentKernel::keepPoints(frame.times.data(), frame.frequencies.data(), frame.magnitudes.data(), frame.numBins, settings.noiseFloorDb);
+            partialTracker.process(frame);
+
+            for (int s = 0; s < frame.numPartialSegments; s++) {
+                const auto& segment = frame.partialSegments[(size_t)s];
+                int length = std::snprintf(line, sizeof(line), "%d,%.6f,%.3f,%.6f,%.3f,%.2f\n", segment.trackId,
+                                           frameCentre + segment.startTime, segment.startFrequency,
+                                           frameCentre + segment.endTime, segment.endFrequency, segment.magnitude);
+                partials->write(line, (size_t)length);
+            }
+        }
+    }
+
+    if (points != nullptr) {
+        points->flush();
+
+        if (points->getStatus().failed()) {
+            return points->getStatus().getErrorMessage();
+        }
+    }
+
+    if (partials != nullptr) {
+        partials->flush();
+
+        if (partials->getStatus().failed()) {
+            return partials->getStatus().getErrorMessage();
+        }
+    }
+
+    if (raster != nullptr) {
+        auto imageFile = outputDirectory.getChildFile(input.getFileNameWithoutExtension() + ".png");
+        imageFile.deleteFile();
+        juce::FileOutputStream imageStream(imageFile);
+        juce::PNGImageFormat png;
+
+        if (imageStream.failedToOpen() || !png.writeImageToStream(raster->render(ColourMap::inferno()), imageStream)) {
+            return "couldn't write " + imageFile.getFullPathName();
+        }
+    }
+
+    return {};
+}
+
+void BatchAnalyser::prepareJobs(double sampleRate) {
+    // The generators bake the sample rate in, so a file at a different rate needs a fresh set.
+    if (sampleRate == jobSampleRate) {
+        return;
+    }
+
+    jobs.clear();
+
+    for (int i = 0; i < juce::jmax(1, settings.numThreads); i++) {
+        jobs.add(new FrameJob(*this, settings, sampleRate));
+    }
+
+    jobSampleRate = sampleRate;
+}
+
+void BatchAnalyser::readBatch(juce::AudioFormatReader& reader, juce::int64 startSample, int numSamples) {
+    int numChannels = (int)reader.numChannels;
+    fileBuffer.setSize(numChannels, numSamples, false, false, true);
+    monoBuffer.setSize(1, numSamples, false, false, true);
+    fileBuffer.clear();
+
+    // The first windows reach back before the start of the file.
+    int offset = startSample < 0 ? (int)-startSample : 0;
+
+    if (offset < numSamples) {
+        std::vector<float*> destinations;
+
+        for (int channel = 0; channel < numChannels; channel++) {
+            destinations.push_back(fileBuffer.getWritePointer(channel, offset));
+        }
+
+        reader.read(destinations.data(), numChannels, startSample + offset, numSamples - offset);
+    }
+
+    if (settings.channel >= 0) {
+        monoBuffer.copyFrom(0, 0, fileBuffer, settings.channel, 0, numSamples);
+        return;
+    }
+
+    monoBuffer.copyFrom(0, 0, fileBuffer.getReadPointer(0), numSamples, 1.f / numChannels);
+
+    for (int channel = 1; channel < numChannels; channel++) {
+        monoBuffer.addFrom(0, 0, fileBuffer, channel, 0, numSamples, 1.f / numChannels);
+    }
+}
+
+void BatchAnalyser::analyseBatch(int numFrames) {
+    // Contiguous runs of frames per thread, so each one walks through the input in order.
+    int numJobs = jobs.size();
+    int framesPerJob = (numFrames + numJobs - 1) / numJobs;
+
+    for (int i = 0; i < numJobs; i++) {
+        jobs[i]->firstFrame = juce::jmin(numFrames, i * framesPerJob);
+        jobs[i]->numFrames = juce::jmin(numFrames - jobs[i]->firstFrame, framesPerJob);
+        pool.addJob(jobs[i], false);
+    }
+
+    for (auto* job : jobs) {
+        pool.waitForJobToFinish(job, -1);
+    }
+}
+
+void BatchAnalyser::analyseFrames(FFTDataGenerator& generator, int firstFrame, int numFrames) {
+    for (int i = firstFrame; i < firstFrame + numFrames; i++) {
+        auto& frame = frames[(size_t)i];
+        frame.fftSize = fftSize;
+        frame.numBins = fftSize / 2;
+
+        generator.reassignedSpectrogram(
+            monoBuffer.getReadPointer(0, i * settings.hopSize),
+            frame.times.data(),
+            frame.frequencies.data(),
+            frame.magnitudes.data(),
+            frame.standardFFTResult.data()
+        );
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <JuceHeader.h>
+#include "AnalysisConfiguration.h"
+#include "FFTDataGenerator.h"
+#include "PartialTracker.h"
+#include "SpectralFrame.h"
+#include "SpectrogramRaster.h"
+
+// Runs the plugin's reassignment over whole files, offline.
+// Files are streamed in batches of frames, and the frames of each batch are split across a thread pool,
+// since unlike the real-time case no frame depends on the one before it.
+class BatchAnalyser
+{
+public:
+    struct Settings
+    {
+        int fftOrder = 11;
+        int hopSize = 256;
+        float despecklingCutoff = 1.f;
+        float noiseFloorDb = -96.f;
+
+        // -1 mixes every channel down, anything else analyses just that channel.
+        int channel = -1;
+
+        bool writePoints = true;
+        bool writeImage = true;
+        bool writePartials = false;
+        bool useReassignment = true;
+        int imageHeight = 512;
+        int maxImageWidth = 8192;
+
+        int numThreads = juce::SystemStats::getNumCpus();
+    };
+
+    BatchAnalyser(const Settings& _settings);
+    ~BatchAnalyser();
+
+    // Writes <name>.points.csv, <name>.png and / or <name>.partials.csv into outputDirectory.
+    // Returns an error message on failure.
+    juce::String analyseFile(const juce::File& input, const juce::File& outputDirectory);
+
+    juce::AudioFormatManager& getFormatManager();
+
+private:
+    // One per pool thread, each with its own generator and so its own FFT plan (see AnalysisConfiguration).
+    class FrameJob : public juce::ThreadPoolJob
+    {
+    public:
+        FrameJob(BatchAnalyser& _analyser, const Settings& settings, double sampleRate);
+
+        JobStatus runJob() override;
+
+        int firstFrame;
+        int numFrames;
+
+    private:
+        BatchAnalyser& analyser;
+        AnalysisConfiguration configuration;
+        FFTDataGenerator fftDataGenerator;
+    };
+
+    Settings settings;
+    int fftSize;
+    int framesPerBatch;
+    double jobSampleRate;
+
+    juce::AudioFormatManager formatManager;
+    juce::AudioBuffer<float> fileBuffer;
+    juce::AudioBuffer<float> monoBuffer;
+    std::vector<SpectralFrame> frames;
+    juce::OwnedArray<FrameJob> jobs;
+
+    // Tracking does depend on the frame before, so it runs over each batch in order once it's analysed.
+    PartialTracker partialTracker;
+    juce::ThreadPool pool;
+
+    void prepareJobs(double sampleRate);
+    void readBatch(juce::AudioFormatReader& reader, juce::int64 startSample, int numSamples);
+    void analyseBatch(int numFrames);
+    void analyseFrames(FFTDataGenerator& generator, int firstFrame, int numFrames);
+
+    JUCE_DECLARE_NON_COPYABLE(BatchAnalyser)
+};
@@ -0,0 +1,162 @@
+#include <JuceHeader.h>
+#include <iostream>
+#include "BatchAnalyser.h"
+
+static void printUsage() {
+    std::cout
+        << "Usage: SpectrogramBatch [options] <audio files or directories>...\n"
+        << "\n"
+        << "Runs the reassigned spectrogram over each file and writes <name>.points.csv\n"
+        << "(time_s, frequency_hz, magnitude_db per point) and / or <name>.png, and with --partials\n"
+        << "<name>.partials.csv (the reassigned points linked into tracks, one line per segment).\n"
+        << "Directories are searched recursively for anything JUCE can read (WAV, AIFF, FLAC, ...).\n"
+        << "\n"
+        << "  --fft <size>           1024, 2048, 4096 or 8192 (default 2048)\n"
+        << "  --hop <samples>        hop between frames (default fft / 8)\n"
+        << "  --despeckle <cutoff>   despeckling cutoff, 1 - 10 (default 1)\n"
+        << "  --floor <dB>           points at or below this are skipped (default -96)\n"
+        << "  --channel <n|mix>      analyse one channel, or the average of all of them (default mix)\n"
+        << "  --format <points|png|both>   (default both)\n"
+        << "  --standard             plain FFT magnitudes instead of reassigned points\n"
+        << "  --partials             also track partials across frames\n"
+        << "  --height <pixels>      image height (default 512)\n"
+        << "  --max-width <pixels>   longer files are squeezed into this many columns (default 8192)\n"
+        << "  --threads <n>          worker threads (default: one per core)\n"
+        << "  --output <directory>   where to write the results (default: next to each input)\n";
+}
+
+int main(int argc, char* argv[]) {
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() == 0 || args.containsOption("--help|-h")) {
+        printUsage();
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    BatchAnalyser::Settings settings;
+
+    int fftSize = 2048;
+    int hopSize = 0;
+    juce::String format = "both";
+    juce::String channel = "mix";
+    juce::File outputDirectory;
+
+    if (args.containsOption("--fft")) {
+        fftSize = args.removeValueForOption("--fft").getIntValue();
+    }
+
+    if (args.containsOption("--hop")) {
+        hopSize = args.removeValueForOption("--hop").getIntValue();
+    }
+
+    if (args.containsOption("--despeckle")) {
+        settings.despecklingCutoff = args.removeValueForOption("--despeckle").getFloatValue();
+    }
+
+    if (args.containsOption("--floor")) {
+        settings.noiseFloorDb = args.removeValueForOption("--floor").getFloatValue();
+    }
+
+    if (args.containsOption("--channel")) {
+        channel = args.removeValueForOption("--channel");
+    }
+
+    if (args.containsOption("--format")) {
+        format = args.removeValueForOption("--format");
+    }
+
+    if (args.removeOptionIfFound("--standard")) {
+        settings.useReassignment = false;
+    }
+
+    if (args.removeOptionIfFound("--partials")) {
+        settings.writePartials = true;
+    }
+
+    if (args.containsOption("--height")) {
+        settings.imageHeight = args.removeValueForOption("--height").getIntValue();
+    }
+
+    if (args.containsOption("--max-width")) {
+        settings.maxImageWidth = args.removeValueForOption("--max-width").getIntValue();
+    }
+
+    if (args.containsOption("--threads")) {
+        settings.numThreads = args.removeValueForOption("--threads").getIntValue();
+    }
+
+    if (args.containsOption("--output")) {
+        outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args.removeValueForOption("--output"));
+
+        if (!outputDirectory.createDirectory()) {
+            std::cerr << "couldn't create " << outputDirectory.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    settings.fftOrder = juce::roundToInt(std::log2(juce::jmax(1, fftSize)));
+
+    if ((1 << settings.fftOrder) != fftSize
+        || settings.fftOrder < AnalysisConfigurationCache::minFFTOrder
+        || settings.fftOrder > AnalysisConfigurationCache::maxFFTOrder) {
+        std::cerr << "--fft must be 1024, 2048, 4096 or 8192\n";
+        return 1;
+    }
+
+    settings.hopSize = hopSize > 0 ? hopSize : fftSize / 8;
+    settings.channel = channel == "mix" ? -1 : channel.getIntValue();
+    settings.writePoints = format == "points" || format == "both";
+    settings.writeImage = format == "png" || format == "both";
+    settings.numThreads = juce::jmax(1, settings.numThreads);
+    settings.imageHeight = juce::jmax(16, settings.imageHeight);
+    settings.maxImageWidth = juce::jmax(16, settings.maxImageWidth);
+
+    if (!settings.writePoints && !settings.writeImage) {
+        std::cerr << "--format must be points, png or both\n";
+        return 1;
+    }
+
+    BatchAnalyser analyser(settings);
+    auto wildcard = analyser.getFormatManager().getWildcardForAllFormats();
+
+    // Whatever is left over are the inputs.
+    juce::Array<juce::File> inputs;
+
+    for (auto& argument : args.arguments) {
+        auto file = argument.resolveAsFile();
+
+        if (file.isDirectory()) {
+            for (auto& entry : juce::RangedDirectoryIterator(file, true, wildcard, juce::File::findFiles)) {
+                inputs.add(entry.getFile());
+            }
+        }
+        else if (file.existsAsFile()) {
+            inputs.add(file);
+        }
+        else {
+            std::cerr << "skipping " << argument.text << ": no such file or directory\n";
+        }
+    }
+
+    int numFailed = 0;
+
+    for (int i = 0; i < inputs.size(); i++) {
+        auto& input = inputs.getReference(i);
+        auto destination = outputDirectory == juce::File() ? input.getParentDirectory() : outputDirectory;
+        auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+        std::cout << "[" << (i + 1) << "/" << inputs.size() << "] " << input.getFullPathName() << std::flush;
+
+        auto error = analyser.analyseFile(input, destination);
+
+        if (error.isNotEmpty()) {
+            std::cout << " failed: " << error << "\n";
+            numFailed++;
+        }
+        else {
+            std::cout << " (" << juce::String((juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0, 2) << " s)\n";
+        }
+    }
+
+    return numFailed == 0 ? 0 : 1;
+}
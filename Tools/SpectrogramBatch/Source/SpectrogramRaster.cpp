@@ -0,0 +1,72 @@
+#include "SpectrogramRaster.h"
+
+SpectrogramRaster::SpectrogramRaster(int _width, int _height, double _framesPerColumn, float _minFrequency, float _maxFrequency, float _floorDb):
+    width(_width),
+    height(_height),
+    framesPerColumn(_framesPerColumn),
+    minFrequency(_minFrequency),
+    maxFrequency(_maxFrequency),
+    floorDb(_floorDb),
+    pixels((size_t)_width * (size_t)_height, _floorDb)
+{
+}
+
+void SpectrogramRaster::addPoint(double frame, float frequency, float magnitudeDb) {
+    accumulate(getColumn(frame), getRow(frequency), magnitudeDb);
+}
+
+void SpectrogramRaster::addBand(double frame, float lowFrequency, float highFrequency, float magnitudeDb) {
+    int column = getColumn(frame);
+    int top = getRow(highFrequency);
+    int bottom = getRow(lowFrequency);
+
+    for (int row = juce::jmax(0, top); row <= juce::jmin(height - 1, bottom); row++) {
+        accumulate(column, row, magnitudeDb);
+    }
+}
+
+juce::Image SpectrogramRaster::render(const juce::ColourGradient& colours) const {
+    float peakDb = floorDb;
+
+    for (auto value : pixels) {
+        peakDb = juce::jmax(peakDb, value);
+    }
+
+    juce::Image image(juce::Image::RGB, width, height, true);
+
+    if (peakDb <= floorDb) {
+        return image;
+    }
+
+    for (int row = 0; row < height; row++) {
+        for (int column = 0; column < width; column++) {
+            float value = pixels[(size_t)row * width + column];
+            image.setPixelAt(column, row, colours.getColourAtPosition(juce::jmap(value, floorDb, peakDb, 0.f, 1.f)));
+        }
+    }
+
+    return image;
+}
+
+int SpectrogramRaster::getColumn(double frame) const {
+    return (int)std::floor(frame / framesPerColumn);
+}
+
+int SpectrogramRaster::getRow(float frequency) const {
+    // Same logarithmic axis as the editor, flipped so that row 0 is the top of the image.
+    if (frequency <= minFrequency) {
+        return height;
+    }
+
+    float position = std::log(frequency / minFrequency) / std::log(maxFrequency / minFrequency);
+    return height - 1 - (int)(position * (height - 1));
+}
+
+void SpectrogramRaster::accumulate(int column, int row, float magnitudeDb) {
+    if (column < 0 || column >= width || row < 0 || row >= height) {
+        return;
+    }
+
+    auto& pixel = pixels[(size_t)row * width + column];
+    pixel = juce::jmax(pixel, magnitudeDb);
+}
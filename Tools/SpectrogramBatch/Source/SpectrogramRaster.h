@@ -0,0 +1,32 @@
+#pragma once
+#include <JuceHeader.h>
+
+// A fixed-size grid of the loudest magnitude that landed on each pixel, for writing a whole file's
+// spectrogram out as one image. Long files are squeezed into the width by giving each column several frames.
+class SpectrogramRaster
+{
+public:
+    SpectrogramRaster(int _width, int _height, double _framesPerColumn, float _minFrequency, float _maxFrequency, float _floorDb);
+
+    // frame may be fractional, reassigned points rarely sit exactly on a frame.
+    void addPoint(double frame, float frequency, float magnitudeDb);
+
+    // Fills the rows between two frequencies, for plain FFT bins.
+    void addBand(double frame, float lowFrequency, float highFrequency, float magnitudeDb);
+
+    // Maps floorDb .. the loudest pixel onto the colour map, low frequencies at the bottom.
+    juce::Image render(const juce::ColourGradient& colours) const;
+
+private:
+    int width;
+    int height;
+    double framesPerColumn;
+    float minFrequency;
+    float maxFrequency;
+    float floorDb;
+    std::vector<float> pixels;
+
+    int getColumn(double frame) const;
+    int getRow(float frequency) const;
+    void accumulate(int column, int row, float magnitudeDb);
+};
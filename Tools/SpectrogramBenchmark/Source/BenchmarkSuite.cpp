@@ -0,0 +1,412 @@
+#include "BenchmarkSuite.h"
+#include "AllocationGuard.h"
+#include "AnalysisConfiguration.h"
+#include "AnalysisRingBuffer.h"
+#include "Decimator.h"
+#include "FFTDataGenerator.h"
+#include "MultiResolutionAnalysis.h"
+#include "PartialTracker.h"
+#include "ReassignedAccumulator.h"
+#include "ReassignmentKernel.h"
+#include "SlidingDFT.h"
+#include "SpectralFrame.h"
+#include "SpectrogramRenderer.h"
+
+// Enough distinct frames that a benchmark isn't just re-running one window that sits in the cache.
+static constexpr int framesPerSignal = 256;
+static constexpr int renderedFramesPerSignal = 64;
+
+// The plugin's default, so rendered frames carry as many points as they would there.
+static constexpr float noiseFloorDb = -48.f;
+
+// Keeps the optimiser from throwing away work whose result nothing reads.
+static void doNotOptimiseAway(const void* pointer) {
+    static std::atomic<const void*> sink;
+    sink.store(pointer, std::memory_order_relaxed);
+}
+
+juce::String BenchmarkSuite::Result::getKey() const {
+    return benchmark + "/" + juce::String(fftSize) + "/" + signal;
+}
+
+double BenchmarkSuite::Result::getChange() const {
+    return baselineNsPerFrame > 0 ? nsPerFrame / baselineNsPerFrame - 1.0 : 0.0;
+}
+
+BenchmarkSuite::BenchmarkSuite(const Settings& _settings):
+    settings(_settings)
+{
+    jassert(settings.hopDivisor > 0 && settings.repeats > 0);
+}
+
+juce::Array<BenchmarkSuite::Result> BenchmarkSuite::run(const std::function<void(const Result&)>& onResult) {
+    juce::Array<Result> results;
+
+    auto add = [&](const Result& result) {
+        results.add(result);
+        onResult(result);
+    };
+
+    for (int fftOrder : settings.fftOrders) {
+        int fftSize = 1 << fftOrder;
+        int hopSize = fftSize / settings.hopDivisor;
+        double audioSecondsPerFrame = hopSize / settings.sampleRate;
+
+        // What updateParameters used to do on every change: regenerate the four windows. It now happens once per
+        // size, up front, so this is the cost that moved off the audio thread. The FFT plans are each generator's
+        // own and built when its size changes, on the analysis thread.
+        if (shouldRun("buildConfiguration")) {
+            add(measure("buildConfiguration", fftSize, "none", 0, [&](int) {
+                AnalysisConfiguration configuration(fftOrder);
+                doNotOptimiseAway(configuration.standardWindow.data());
+            }));
+        }
+
+        AnalysisConfiguration configuration(fftOrder);
+        FFTDataGenerator generator((int)settings.sampleRate);
+        generator.updateParameters(configuration, 1.f);
+
+        if (shouldRun("updateParameters")) {
+            add(measure("updateParameters", fftSize, "none", 0, [&](int frame) {
+                generator.updateParameters(configuration, 1.f + (frame & 1));
+            }));
+        }
+
+        generator.updateParameters(configuration, 1.f);
+
+        int numSamples = fftSize + hopSize * (framesPerSignal - 1);
+        juce::HeapBlock<float> signal((size_t)numSamples);
+        juce::HeapBlock<float> spectra((size_t)(4 * fftSize / 2));
+        auto frame = std::make_unique<SpectralFrame>();
+        frame->fftSize = fftSize;
+        frame->numBins = fftSize / 2;
+
+        for (auto signalType : settings.signals) {
+            auto signalName = TestSignals::getName(signalType);
+            TestSignals::generate(signalType, signal, numSamples, settings.sampleRate);
+
+            if (shouldRun("doFFT")) {
+                add(measure("doFFT", fftSize, signalName, audioSecondsPerFrame, [&](int index) {
+                    generator.doFFT(
+                        signal + (index % framesPerSignal) * hopSize,
+                        configuration.standardWindow.data(),
+                        configuration.derivativeWindow.data(),
+                        configuration.derivativeWindowGain,
+                        spectra,
+                        spectra + fftSize / 2,
+                        spectra + fftSize,
+                        spectra + 3 * fftSize / 2
+                    );
+                    doNotOptimiseAway(spectra);
+                }));
+            }
+
+            if (shouldRun("reassignedSpectrogram")) {
+                add(measure("reassignedSpectrogram", fftSize, signalName, audioSecondsPerFrame, [&](int index) {
+                    generator.reassignedSpectrogram(
+                        signal + (index % framesPerSignal) * hopSize,
+                        frame->times.data(),
+                        frame->frequencies.data(),
+                        frame->magnitudes.data(),
+                        frame->standardFFTResult.data()
+                    );
+                    doNotOptimiseAway(frame.get());
+                }));
+            }
+
+            if (!shouldRun("updateSpectrogram/standard") && !shouldRun("updateSpectrogram/reassigned")
+                && !shouldRun("accumulate") && !shouldRun("updateSpectrogram/accumulated")
+                && !shouldRun("trackPartials") && !shouldRun("updateSpectrogram/partials")) {
+                continue;
+            }
+
+            // Render real analysed frames, so the points land where they would in the editor.
+            std::vector<SpectralFrame> frames((size_t)renderedFramesPerSignal);
+
+            for (int i = 0; i < renderedFramesPerSignal; i++) {
+                auto& rendered = frames[(size_t)i];
+                rendered.fftSize = fftSize;
+                rendered.numBins = fftSize / 2;
+                generator.reassignedSpectrogram(
+                    signal + i * (framesPerSignal / renderedFramesPerSignal) * hopSize,
+                    rendered.times.data(),
+                    rendered.frequencies.data(),
+                    rendered.magnitudes.data(),
+                    rendered.standardFFTResult.data()
+                );
+                rendered.numPoints = ReassignmentKernel::keepPoints(rendered.times.data(), rendered.frequencies.data(), rendered.magnitudes.data(), fftSize / 2, noiseFloorDb);
+            }
+
+            // The analysis side's half of the accumulated view, and the columns the renderer gets from it.
+            ReassignedAccumulator accumulator((int)settings.sampleRate);
+            accumulator.prepare(FrequencyAxis::Scale::log, 20.f, 24000.f, settings.imageHeight, fftSize, hopSize);
+
+            if (shouldRun("accumulate")) {
+                add(measure("accumulate", fftSize, signalName, audioSecondsPerFrame, [&](int index) {
+                    accumulator.process(frames[(size_t)(index % renderedFramesPerSignal)]);
+                }));
+            }
+
+            for (auto& rendered : frames) {
+                accumulator.process(rendered);
+            }
+
+            SpectrogramRenderer renderer;
+            renderer.setSize(settings.imageWidth, settings.imageHeight);
+            renderer.setSampleRate((float)settings.sampleRate);
+            renderer.setColumnsPerSecond((float)settings.sampleRate / (float)hopSize);
+            renderer.setStreamLayout(1, false);
+
+            // The renderer places frames by sample clock, so the reused frames are moved on a hop each time
+            // to get one new column per frame.
+            auto nextFrame = [&](int index) -> SpectralFrame& {
+                auto& rendered = frames[(size_t)(index % renderedFramesPerSignal)];
+                rendered.samplePosition = fftSize + (juce::int64)index * hopSize;
+                rendered.accumulatedSamplePosition = rendered.samplePosition - fftSize / 2;
+                return rendered;
+            };
+
+            if (shouldRun("updateSpectrogram/standard")) {
+                add(measure("updateSpectrogram/standard", fftSize, signalName, audioSecondsPerFrame, [&](int index) {
+                    renderer.updateSpectrogram(nextFrame(index), 0);
+                }));
+            }
+
+            if (shouldRun("updateSpectrogram/reassigned")) {
+                add(measure("updateSpectrogram/reassigned", fftSize, signalName, audioSecondsPerFrame, [&](int index) {
+                    renderer.updateSpectrogramReassigned(nextFrame(index), 0);
+                }));
+            }
+
+            if (shouldRun("updateSpectrogram/accumulated")) {
+                add(measure("updateSpectrogram/accumulated", fftSize, signalName, audioSecondsPerFrame, [&](int index) {
+                    renderer.updateSpectrogramAccumulated(nextFrame(index), 0);
+                }));
+            }
+
+            // Wrapping round to the first frame is a jump in the signal, which ends and starts a few tracks.
+            PartialTracker tracker;
+
+            if (shouldRun("trackPartials")) {
+                add(measure("trackPartials", fftSize, signalName, audioSecondsPerFrame, [&](int index) {
+                    tracker.process(nextFrame(index));
+                }));
+            }
+
+            if (shouldRun("updateSpectrogram/partials")) {
+                // Each frame keeps the segments from one pass of the tracker over them in order.
+                tracker.reset();
+
+                for (int i = 0; i < renderedFramesPerSignal; i++) {
+                    tracker.process(nextFrame(i));
+                }
+
+                add(measure("updateSpectrogram/partials", fftSize, signalName, audioSecondsPerFrame, [&](int index) {
+                    renderer.updateSpectrogramPartials(nextFrame(index), 0);
+                }));
+            }
+        }
+    }
+
+    // Every size fused at the smallest size's hop, against reassignedSpectrogram at 8192 for what the largest
+    // size alone would cost at that hop.
+    if (shouldRun("multiResolution")) {
+        AnalysisConfigurationCache configurations;
+        configurations.waitUntilBuilt(60000);
+
+        int hopSize = (1 << AnalysisConfigurationCache::minFFTOrder) / settings.hopDivisor;
+        double audioSecondsPerFrame = hopSize / settings.sampleRate;
+        int numSamples = SpectralFrame::maxFFTSize + hopSize * framesPerSignal;
+        juce::AudioBuffer<float> input(1, numSamples);
+        AnalysisRingBuffer ringBuffer(1, SpectralFrame::maxFFTSize);
+        MultiResolutionAnalysis analysis((int)settings.sampleRate);
+        analysis.updateParameters(configurations, AnalysisConfiguration::Window::blackmanHarris, 1.f);
+        auto frame = std::make_unique<SpectralFrame>();
+
+        for (auto signalType : settings.signals) {
+            TestSignals::generate(signalType, input.getWritePointer(0), numSamples, settings.sampleRate);
+            ringBuffer.push(input, 0, 0, SpectralFrame::maxFFTSize);
+            analysis.reset();
+
+            add(measure("multiResolution", SpectralFrame::maxFFTSize, TestSignals::getName(signalType), audioSecondsPerFrame, [&](int index) {
+                ringBuffer.push(input, 0, SpectralFrame::maxFFTSize + (index % framesPerSignal) * hopSize, hopSize);
+                analysis.analyse(ringBuffer, *frame);
+            }));
+        }
+    }
+
+    // Sliding every bin along a sample at a time, at the largest hop it's used for. Compare with
+    // reassignedSpectrogram, which costs the same per frame whatever the hop.
+    if (shouldRun("slidingDFT")) {
+        int hopSize = SlidingDFT::maxHopSize;
+        double audioSecondsPerFrame = hopSize / settings.sampleRate;
+
+        for (int fftOrder : settings.fftOrders) {
+            int fftSize = 1 << fftOrder;
+            int numSamples = fftSize + hopSize * framesPerSignal;
+            juce::HeapBlock<float> signal((size_t)numSamples);
+            AnalysisConfiguration configuration(fftOrder);
+            SlidingDFT slidingDFT((int)settings.sampleRate);
+            auto frame = std::make_unique<SpectralFrame>();
+
+            for (auto signalType : settings.signals) {
+                TestSignals::generate(signalType, signal, numSamples, settings.sampleRate);
+                slidingDFT.reset();
+                slidingDFT.push(signal, fftSize);
+                slidingDFT.updateParameters(&configuration, 1.f);
+
+                add(measure("slidingDFT", fftSize, TestSignals::getName(signalType), audioSecondsPerFrame, [&](int index) {
+                    slidingDFT.push(signal + fftSize + (index % framesPerSignal) * hopSize, hopSize);
+                    slidingDFT.reassignedSpectrogram(frame->times.data(), frame->frequencies.data(), frame->magnitudes.data(), frame->standardFFTResult.data());
+                    doNotOptimiseAway(frame.get());
+                }));
+
+                slidingDFT.updateParameters(nullptr, 1.f);
+            }
+        }
+    }
+
+    // The zoom front-end, decimating one hop's worth of analysed samples zoomed in to 500 Hz.
+    if (shouldRun("decimate")) {
+        int factor = Decimator::getFactorFor(settings.sampleRate, 500.f);
+
+        for (int fftOrder : settings.fftOrders) {
+            int hopSize = (1 << fftOrder) / settings.hopDivisor;
+            int numInputSamples = hopSize * factor;
+            int numBlocks = 4;
+            juce::HeapBlock<float> signal((size_t)(numInputSamples * numBlocks));
+            juce::HeapBlock<float> output((size_t)numInputSamples);
+            Decimator decimator;
+            decimator.setFactor(factor);
+
+            for (auto signalType : settings.signals) {
+                TestSignals::generate(signalType, signal, numInputSamples * numBlocks, settings.sampleRate);
+                decimator.reset();
+
+                add(measure("decimate", 1 << fftOrder, TestSignals::getName(signalType), numInputSamples / settings.sampleRate, [&](int index) {
+                    decimator.process(signal + (index % numBlocks) * numInputSamples, numInputSamples, output);
+                    doNotOptimiseAway(output.get());
+                }));
+            }
+        }
+    }
+
+    return results;
+}
+
+juce::var BenchmarkSuite::toJSON(const juce::Array<Result>& results) const {
+    juce::Array<juce::var> entries;
+
+    for (auto& result : results) {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("benchmark", result.benchmark);
+        entry->setProperty("fftSize", result.fftSize);
+        entry->setProperty("signal", result.signal);
+        entry->setProperty("framesPerPass", result.framesPerPass);
+        entry->setProperty("nsPerFrame", result.nsPerFrame);
+        entry->setProperty("minNsPerFrame", result.minNsPerFrame);
+        entry->setProperty("framesPerSecond", result.framesPerSecond);
+        entry->setProperty("allocationsPerFrame", result.allocationsPerFrame >= 0 ? juce::var(result.allocationsPerFrame) : juce::var());
+        entry->setProperty("realTimeFactor", result.realTimeFactor > 0 ? juce::var(result.realTimeFactor) : juce::var());
+
+        if (result.baselineNsPerFrame > 0) {
+            entry->setProperty("baselineNsPerFrame", result.baselineNsPerFrame);
+            entry->setProperty("change", result.getChange());
+        }
+
+        entries.add(juce::var(entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("version", 1);
+    root->setProperty("sampleRate", settings.sampleRate);
+    root->setProperty("hopDivisor", settings.hopDivisor);
+    root->setProperty("repeats", settings.repeats);
+    root->setProperty("imageWidth", settings.imageWidth);
+    root->setProperty("imageHeight", settings.imageHeight);
+    root->setProperty("countsAllocations", AllocationGuard::isEnabled());
+    root->setProperty("operatingSystem", juce::SystemStats::getOperatingSystemName());
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("results", entries);
+
+    return juce::var(root);
+}
+
+juce::String BenchmarkSuite::compareWithBaseline(const juce::var& baseline, juce::Array<Result>& results) {
+    auto* entries = baseline["results"].getArray();
+
+    if (entries == nullptr) {
+        return "the baseline has no results";
+    }
+
+    std::map<juce::String, double> baselineNsPerFrame;
+
+    for (auto& entry : *entries) {
+        Result previous;
+        previous.benchmark = entry["benchmark"].toString();
+        previous.fftSize = entry["fftSize"];
+        previous.signal = entry["signal"].toString();
+        baselineNsPerFrame[previous.getKey()] = entry["nsPerFrame"];
+    }
+
+    for (auto& result : results) {
+        auto found = baselineNsPerFrame.find(result.getKey());
+        result.baselineNsPerFrame = found != baselineNsPerFrame.end() ? found->second : 0;
+    }
+
+    return {};
+}
+
+bool BenchmarkSuite::shouldRun(const juce::String& benchmark) const {
+    return settings.filter.isEmpty() || benchmark.contains(settings.filter);
+}
+
+BenchmarkSuite::Result BenchmarkSuite::measure(const juce::String& benchmark, int fftSize, const juce::String& signal, double audioSecondsPerFrame,
+                                               const std::function<void(int frame)>& runFrame) const {
+    auto timePass = [&](juce::int64 numFrames) {
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (juce::int64 i = 0; i < numFrames; i++) {
+            runFrame((int)(i & 0x7fffffff));
+        }
+
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    };
+
+    // Double the pass length until it's long enough for the timer, which doubles as a warm-up.
+    juce::int64 framesPerPass = 1;
+
+    while (timePass(framesPerPass) * 1000.0 < settings.minPassMs && framesPerPass < (1 << 24)) {
+        framesPerPass *= 2;
+    }
+
+    std::vector<double> nsPerFrame;
+    nsPerFrame.reserve((size_t)settings.repeats);
+    auto allocationsBefore = AllocationGuard::getNumAllocationsOnThisThread();
+
+    for (int repeat = 0; repeat < settings.repeats; repeat++) {
+        nsPerFrame.push_back(timePass(framesPerPass) * 1.0e9 / (double)framesPerPass);
+    }
+
+    auto numAllocations = AllocationGuard::getNumAllocationsOnThisThread() - allocationsBefore;
+    std::sort(nsPerFrame.begin(), nsPerFrame.end());
+
+    Result result;
+    result.benchmark = benchmark;
+    result.fftSize = fftSize;
+    result.signal = signal;
+    result.framesPerPass = framesPerPass;
+    result.nsPerFrame = nsPerFrame[nsPerFrame.size() / 2];
+    result.minNsPerFrame = nsPerFrame.front();
+    result.framesPerSecond = 1.0e9 / result.nsPerFrame;
+
+    if (AllocationGuard::isEnabled()) {
+        result.allocationsPerFrame = (double)numAllocations / (double)(framesPerPass * settings.repeats);
+    }
+
+    if (audioSecondsPerFrame > 0) {
+        result.realTimeFactor = audioSecondsPerFrame * result.framesPerSecond;
+    }
+
+    return result;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <JuceHeader.h>
+#include "TestSignals.h"
+
+// Times the analysis and rendering hot paths per frame, for each FFT size and test signal.
+// Every benchmark is calibrated to run for at least minPassMs per pass, then repeated,
+// and the median pass is reported so one descheduled pass doesn't skew the result.
+class BenchmarkSuite
+{
+public:
+    struct Settings
+    {
+        double sampleRate = 48000;
+        int hopDivisor = 8;
+        int repeats = 7;
+        double minPassMs = 50;
+        int imageWidth = 512;
+        int imageHeight = 512;
+
+        juce::Array<int> fftOrders = { 10, 11, 12, 13 };
+        juce::Array<TestSignals::Type> signals = { TestSignals::Type::sine, TestSignals::Type::chirp, TestSignals::Type::noise, TestSignals::Type::impulses };
+
+        // Only run benchmarks whose name contains this.
+        juce::String filter;
+    };
+
+    struct Result
+    {
+        juce::String benchmark;
+        int fftSize = 0;
+        juce::String signal;
+
+        juce::int64 framesPerPass = 0;
+        double nsPerFrame = 0;
+        double minNsPerFrame = 0;
+        double framesPerSecond = 0;
+
+        // -1 if the build doesn't count allocations (see AllocationGuard).
+        double allocationsPerFrame = -1;
+
+        // Seconds of audio analysed (or drawn) per second of work, 0 for benchmarks that aren't per hop.
+        double realTimeFactor = 0;
+
+        // Filled in by compareWithBaseline, 0 if the baseline didn't have this benchmark.
+        double baselineNsPerFrame = 0;
+
+        juce::String getKey() const;
+
+        // Relative to the baseline: 0.1 is 10% slower, -0.1 is 10% faster.
+        double getChange() const;
+    };
+
+    BenchmarkSuite(const Settings& _settings);
+
+    // Runs everything, calling back as each result comes in so progress can be shown.
+    juce::Array<Result> run(const std::function<void(const Result&)>& onResult);
+
+    juce::var toJSON(const juce::Array<Result>& results) const;
+
+    // Matches results against a previous toJSON() run. Returns an error message if the baseline can't be used.
+    static juce::String compareWithBaseline(const juce::var& baseline, juce::Array<Result>& results);
+
+private:
+    Settings settings;
+
+    bool shouldRun(const juce::String& benchmark) const;
+
+    Result measure(const juce::String& benchmark, int fftSize, const juce::String& signal, double audioSecondsPerFrame,
+                   const std::function<void(int frame)>& runFrame) const;
+
+    JUCE_DECLARE_NON_COPYABLE(BenchmarkSuite)
+};
@@ -0,0 +1,165 @@
+#include <JuceHeader.h>
+#include <iostream>
+#include "AnalysisConfiguration.h"
+#include "BenchmarkSuite.h"
+
+static void printUsage() {
+    std::cout
+        << "Usage: SpectrogramBenchmark [options]\n"
+        << "\n"
+        << "Times the analysis and rendering hot paths on synthetic signals and reports ns/frame,\n"
+        << "frames/s, allocations per frame and the real-time factor (seconds of audio per second of work).\n"
+        << "Build it in Release, the numbers from a debug build don't mean much.\n"
+        << "\n"
+        << "  --fft <sizes>          comma separated, from 1024, 2048, 4096, 8192 (default all)\n"
+        << "  --signals <names>      comma separated, from sine, chirp, noise, impulses (default all)\n"
+        << "  --filter <text>        only run benchmarks whose name contains this\n"
+        << "  --hop-divisor <n>      hop = fft / n, used for the real-time factor (default 8)\n"
+        << "  --repeats <n>          timed passes per benchmark, the median is reported (default 7)\n"
+        << "  --min-pass-ms <ms>     each pass runs at least this long (default 50)\n"
+        << "  --output <file>        write the results as JSON\n"
+        << "  --baseline <file>      compare against the JSON from an earlier run\n"
+        << "  --tolerance <percent>  with --baseline, exit with 2 if anything got this much slower (default 5)\n";
+}
+
+int main(int argc, char* argv[]) {
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h")) {
+        printUsage();
+        return 0;
+    }
+
+    BenchmarkSuite::Settings settings;
+    juce::File outputFile;
+    juce::File baselineFile;
+    double tolerance = 0.05;
+
+    if (args.containsOption("--fft")) {
+        settings.fftOrders.clear();
+
+        for (auto& size : juce::StringArray::fromTokens(args.removeValueForOption("--fft"), ",", {})) {
+            int fftOrder = juce::roundToInt(std::log2(juce::jmax(1, size.getIntValue())));
+
+            if ((1 << fftOrder) != size.getIntValue()
+                || fftOrder < AnalysisConfigurationCache::minFFTOrder
+                || fftOrder > AnalysisConfigurationCache::maxFFTOrder) {
+                std::cerr << "--fft sizes must be 1024, 2048, 4096 or 8192\n";
+                return 1;
+            }
+
+            settings.fftOrders.add(fftOrder);
+        }
+    }
+
+    if (args.containsOption("--signals")) {
+        settings.signals.clear();
+
+        for (auto& name : juce::StringArray::fromTokens(args.removeValueForOption("--signals"), ",", {})) {
+            TestSignals::Type type;
+
+            if (!TestSignals::fromName(name, type)) {
+                std::cerr << "unknown signal " << name << "\n";
+                return 1;
+            }
+
+            settings.signals.add(type);
+        }
+    }
+
+    if (args.containsOption("--filter")) {
+        settings.filter = args.removeValueForOption("--filter");
+    }
+
+    if (args.containsOption("--hop-divisor")) {
+        settings.hopDivisor = juce::jmax(1, args.removeValueForOption("--hop-divisor").getIntValue());
+    }
+
+    if (args.containsOption("--repeats")) {
+        settings.repeats = juce::jmax(1, args.removeValueForOption("--repeats").getIntValue());
+    }
+
+    if (args.containsOption("--min-pass-ms")) {
+        settings.minPassMs = juce::jmax(1.0, args.removeValueForOption("--min-pass-ms").getDoubleValue());
+    }
+
+    if (args.containsOption("--output")) {
+        outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.removeValueForOption("--output"));
+    }
+
+    if (args.containsOption("--baseline")) {
+        baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.removeValueForOption("--baseline"));
+    }
+
+    if (args.containsOption("--tolerance")) {
+        tolerance = args.removeValueForOption("--tolerance").getDoubleValue() / 100.0;
+    }
+
+    // Read the baseline up front, there's no point running for minutes to then fail on a typo.
+    juce::var baseline;
+
+    if (baselineFile != juce::File()) {
+        auto parsed = juce::JSON::parse(baselineFile.loadFileAsString());
+
+        if (!baselineFile.existsAsFile() || !parsed.isObject()) {
+            std::cerr << "couldn't read a baseline from " << baselineFile.getFullPathName() << "\n";
+            return 1;
+        }
+
+        baseline = parsed;
+    }
+
+    BenchmarkSuite suite(settings);
+
+    std::cout << juce::String("benchmark").paddedRight(' ', 30) << juce::String("fft").paddedLeft(' ', 6) << "  "
+              << juce::String("signal").paddedRight(' ', 9) << juce::String("ns/frame").paddedLeft(' ', 12)
+              << juce::String("frames/s").paddedLeft(' ', 12) << juce::String("allocs").paddedLeft(' ', 9)
+              << juce::String("x realtime").paddedLeft(' ', 12) << "\n";
+
+    auto results = suite.run([](const BenchmarkSuite::Result& result) {
+        std::cout << result.benchmark.paddedRight(' ', 30) << juce::String(result.fftSize).paddedLeft(' ', 6) << "  "
+                  << result.signal.paddedRight(' ', 9) << juce::String(result.nsPerFrame, 0).paddedLeft(' ', 12)
+                  << juce::String(result.framesPerSecond, 0).paddedLeft(' ', 12)
+                  << (result.allocationsPerFrame >= 0 ? juce::String(result.allocationsPerFrame, 2) : juce::String("-")).paddedLeft(' ', 9)
+                  << (result.realTimeFactor > 0 ? juce::String(result.realTimeFactor, 1) : juce::String("-")).paddedLeft(' ', 12)
+                  << "\n" << std::flush;
+    });
+
+    int numRegressions = 0;
+
+    if (baseline.isObject()) {
+        auto error = BenchmarkSuite::compareWithBaseline(baseline, results);
+
+        if (error.isNotEmpty()) {
+            std::cerr << baselineFile.getFileName() << ": " << error << "\n";
+            return 1;
+        }
+
+        std::cout << "\nAgainst " << baselineFile.getFileName() << ":\n";
+
+        for (auto& result : results) {
+            if (result.baselineNsPerFrame <= 0) {
+                std::cout << "  " << result.getKey() << ": not in the baseline\n";
+                continue;
+            }
+
+            auto change = result.getChange();
+            juce::String verdict = change > tolerance ? "  SLOWER" : (change < -tolerance ? "  faster" : "");
+            numRegressions += change > tolerance ? 1 : 0;
+
+            std::cout << "  " << result.getKey().paddedRight(' ', 48)
+                      << (change >= 0 ? "+" : "") << juce::String(change * 100.0, 1) << "%" << verdict << "\n";
+        }
+    }
+
+    if (outputFile != juce::File()) {
+        if (!outputFile.replaceWithText(juce::JSON::toString(suite.toJSON(results)))) {
+            std::cerr << "couldn't write " << outputFile.getFullPathName() << "\n";
+            return 1;
+        }
+
+        std::cout << "\nWrote " << outputFile.getFullPathName() << "\n";
+    }
+
+    return numRegressions == 0 ? 0 : 2;
+}
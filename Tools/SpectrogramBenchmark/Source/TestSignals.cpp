@@ -0,0 +1,74 @@
+#include "TestSignals.h"
+
+juce::String TestSignals::getName(Type type) {
+    switch (type) {
+        case Type::sine: return "sine";
+        case Type::chirp: return "chirp";
+        case Type::noise: return "noise";
+        case Type::impulses: return "impulses";
+    }
+
+    return {};
+}
+
+bool TestSignals::fromName(const juce::String& name, Type& type) {
+    for (auto candidate : allTypes) {
+        if (getName(candidate) == name.trim().toLowerCase()) {
+            type = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TestSignals::generate(Type type, float* destination, int numSamples, double sampleRate) {
+    const float amplitude = 0.5f;
+
+    switch (type) {
+        case Type::sine: {
+            double phaseIncrement = juce::MathConstants<double>::twoPi * 1000.0 / sampleRate;
+
+            for (int i = 0; i < numSamples; i++) {
+                destination[i] = amplitude * (float)std::sin(phaseIncrement * i);
+            }
+
+            break;
+        }
+
+        case Type::chirp: {
+            // Exponential sweep from 20 Hz up to 20 kHz over the whole signal.
+            double duration = numSamples / sampleRate;
+            double rate = std::log(20000.0 / 20.0) / duration;
+
+            for (int i = 0; i < numSamples; i++) {
+                double time = i / sampleRate;
+                double phase = juce::MathConstants<double>::twoPi * 20.0 * (std::exp(rate * time) - 1.0) / rate;
+                destination[i] = amplitude * (float)std::sin(phase);
+            }
+
+            break;
+        }
+
+        case Type::noise: {
+            juce::Random random(0x5eed);
+
+            for (int i = 0; i < numSamples; i++) {
+                destination[i] = amplitude * (random.nextFloat() * 2.f - 1.f);
+            }
+
+            break;
+        }
+
+        case Type::impulses: {
+            // A click every 10 ms.
+            int period = juce::jmax(1, juce::roundToInt(sampleRate / 100));
+
+            for (int i = 0; i < numSamples; i++) {
+                destination[i] = i % period == 0 ? amplitude : 0.f;
+            }
+
+            break;
+        }
+    }
+}
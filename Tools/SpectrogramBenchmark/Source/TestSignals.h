@@ -0,0 +1,26 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Synthetic input for the benchmarks. Each one stresses the reassignment a little differently:
+// a steady sine concentrates everything in a couple of bins, a chirp moves through every band,
+// noise spreads energy everywhere, and impulses smear it across time instead of frequency.
+namespace TestSignals
+{
+    enum class Type
+    {
+        sine,
+        chirp,
+        noise,
+        impulses
+    };
+
+    constexpr std::array<Type, 4> allTypes = { Type::sine, Type::chirp, Type::noise, Type::impulses };
+
+    juce::String getName(Type type);
+
+    // Returns false if the name isn't one of the above.
+    bool fromName(const juce::String& name, Type& type);
+
+    // Always generates the same samples for the same arguments, so runs can be compared with each other.
+    void generate(Type type, float* destination, int numSamples, double sampleRate);
+}
@@ -0,0 +1,77 @@
+#include "LockCounter.h"
+
+#if JUCE_LINUX
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+static thread_local juce::int64 numLocks = 0;
+
+// Resolved on first use, without a function-local static: its initialisation guard could itself take a lock.
+template <typename Function>
+static Function findNext(std::atomic<Function>& next, const char* name) {
+    auto function = next.load(std::memory_order_acquire);
+
+    if (function == nullptr) {
+        function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+        next.store(function, std::memory_order_release);
+    }
+
+    return function;
+}
+
+using MutexFunction = int (*)(pthread_mutex_t*);
+using ReadWriteLockFunction = int (*)(pthread_rwlock_t*);
+using SemaphoreFunction = int (*)(sem_t*);
+
+static std::atomic<MutexFunction> nextMutexLock { nullptr };
+static std::atomic<MutexFunction> nextMutexTryLock { nullptr };
+static std::atomic<ReadWriteLockFunction> nextReadLock { nullptr };
+static std::atomic<ReadWriteLockFunction> nextWriteLock { nullptr };
+static std::atomic<SemaphoreFunction> nextSemaphoreWait { nullptr };
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    numLocks++;
+    return findNext(nextMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+extern "C" int pthread_mutex_trylock(pthread_mutex_t* mutex) {
+    numLocks++;
+    return findNext(nextMutexTryLock, "pthread_mutex_trylock")(mutex);
+}
+
+extern "C" int pthread_rwlock_rdlock(pthread_rwlock_t* lock) {
+    numLocks++;
+    return findNext(nextReadLock, "pthread_rwlock_rdlock")(lock);
+}
+
+extern "C" int pthread_rwlock_wrlock(pthread_rwlock_t* lock) {
+    numLocks++;
+    return findNext(nextWriteLock, "pthread_rwlock_wrlock")(lock);
+}
+
+extern "C" int sem_wait(sem_t* semaphore) {
+    numLocks++;
+    return findNext(nextSemaphoreWait, "sem_wait")(semaphore);
+}
+
+bool LockCounter::isAvailable() {
+    return true;
+}
+
+juce::int64 LockCounter::getNumLocksOnThisThread() {
+    return numLocks;
+}
+
+#else
+
+bool LockCounter::isAvailable() {
+    return false;
+}
+
+juce::int64 LockCounter::getNumLocksOnThisThread() {
+    return 0;
+}
+
+#endif
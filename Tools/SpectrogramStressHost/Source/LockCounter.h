@@ -0,0 +1,14 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Counts lock acquisitions per thread, by interposing the pthread locking functions
+// (which juce::CriticalSection, juce::WaitableEvent and std::mutex all end up in).
+// Only available on Linux, where the executable's own definitions win over libc's.
+// Uncontended locks are cheap, but any of them can block the audio thread behind a lower priority one.
+namespace LockCounter
+{
+    bool isAvailable();
+
+    // Locks taken by the calling thread so far, or 0 if counting isn't available.
+    juce::int64 getNumLocksOnThisThread();
+}
@@ -0,0 +1,118 @@
+#include <JuceHeader.h>
+#include <iostream>
+#include "AllocationGuard.h"
+#include "LockCounter.h"
+#include "StressHost.h"
+
+static void printUsage() {
+    std::cout
+        << "Usage: SpectrogramStressHost [options]\n"
+        << "\n"
+        << "Drives the plugin's processBlock like a host would, at 44.1 to 192 kHz, with fixed, irregular and\n"
+        << "oversized blocks, with and without parameter automation, and reports per-callback latency and any\n"
+        << "allocations or locks on the audio thread. Exits with 1 if any scenario went over budget, or if\n"
+        << "processBlock allocated or locked. Build it in Release.\n"
+        << "\n"
+        << "  --seconds <s>          audio per scenario (default 2)\n"
+        << "  --budget <samples>     the buffer size every callback has to fit in (default 64)\n"
+        << "  --filter <text>        only run scenarios whose name contains this, e.g. \"192000\" or \"irregular\"\n"
+        << "  --fast                 call back to back instead of at the audio rate\n"
+        << "  --output <file>        write the results as JSON\n";
+}
+
+int main(int argc, char* argv[]) {
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h")) {
+        printUsage();
+        return 0;
+    }
+
+    // The processor's parameters want a message manager, even if nothing ever runs its loop.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    StressHost::Settings settings;
+    juce::String filter;
+    juce::File outputFile;
+
+    if (args.containsOption("--seconds")) {
+        settings.secondsPerScenario = juce::jmax(0.1, args.removeValueForOption("--seconds").getDoubleValue());
+    }
+
+    if (args.containsOption("--budget")) {
+        settings.budgetSamples = juce::jmax(1, args.removeValueForOption("--budget").getIntValue());
+    }
+
+    if (args.containsOption("--filter")) {
+        filter = args.removeValueForOption("--filter");
+    }
+
+    if (args.removeOptionIfFound("--fast")) {
+        settings.realTime = false;
+    }
+
+    if (args.containsOption("--output")) {
+        outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.removeValueForOption("--output"));
+    }
+
+    if (!AllocationGuard::isEnabled()) {
+        std::cout << "Allocation counting isn't compiled in, allocations will read as 0.\n";
+    }
+
+   #if ! JUCE_LINUX
+    if (AllocationGuard::isEnabled()) {
+        std::cout << "Only operator new is counted outside Linux, allocations through malloc (HeapBlock, AudioBuffer) won't show.\n";
+    }
+   #endif
+
+    if (!LockCounter::isAvailable()) {
+        std::cout << "Lock counting is only available on Linux, locks will read as 0.\n";
+    }
+
+    StressHost host(settings);
+    juce::Array<StressHost::Result> results;
+    int numFailed = 0;
+
+    std::cout << juce::String("scenario").paddedRight(' ', 52) << juce::String("blocks").paddedLeft(' ', 8)
+              << juce::String("p50 us").paddedLeft(' ', 9) << juce::String("p99 us").paddedLeft(' ', 9)
+              << juce::String("p99.9 us").paddedLeft(' ', 10) << juce::String("worst us").paddedLeft(' ', 10)
+              << juce::String("budget").paddedLeft(' ', 8) << juce::String("allocs").paddedLeft(' ', 8)
+              << juce::String("locks").paddedLeft(' ', 7) << "\n";
+
+    for (auto& scenario : StressHost::getAllScenarios()) {
+        if (filter.isNotEmpty() && !scenario.getName().contains(filter)) {
+            continue;
+        }
+
+        auto result = host.run(scenario);
+        results.add(result);
+        numFailed += result.passed() ? 0 : 1;
+
+        // Allocations and locks are processBlock's own, with whatever the automation cost in brackets.
+        auto withAutomation = [](juce::int64 processBlock, juce::int64 automation) {
+            return juce::String(processBlock) + (automation > 0 ? " (+" + juce::String(automation) + ")" : juce::String());
+        };
+
+        std::cout << result.scenario.getName().paddedRight(' ', 52) << juce::String(result.numBlocks).paddedLeft(' ', 8)
+                  << juce::String(result.medianUs, 1).paddedLeft(' ', 9) << juce::String(result.p99Us, 1).paddedLeft(' ', 9)
+                  << juce::String(result.p999Us, 1).paddedLeft(' ', 10) << juce::String(result.worstUs, 1).paddedLeft(' ', 10)
+                  << juce::String(result.budgetUs, 0).paddedLeft(' ', 8)
+                  << withAutomation(result.processBlockAllocations, result.automationAllocations).paddedLeft(' ', 8)
+                  << withAutomation(result.processBlockLocks, result.automationLocks).paddedLeft(' ', 7)
+                  << (result.passed() ? "" : "  FAILED") << "\n" << std::flush;
+    }
+
+    if (outputFile != juce::File()) {
+        if (!outputFile.replaceWithText(juce::JSON::toString(host.toJSON(results)))) {
+            std::cerr << "couldn't write " << outputFile.getFullPathName() << "\n";
+            return 1;
+        }
+
+        std::cout << "\nWrote " << outputFile.getFullPathName() << "\n";
+    }
+
+    std::cout << "\n" << (results.size() - numFailed) << " of " << results.size() << " scenarios stayed inside "
+              << settings.budgetSamples << " samples without allocating or locking in processBlock.\n";
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+#include "StressHost.h"
+#include "AllocationGuard.h"
+#include "LockCounter.h"
+
+static double getPercentile(const std::vector<double>& sorted, double percentile) {
+    auto index = (size_t)(percentile * (double)sorted.size());
+    return sorted[juce::jmin(index, sorted.size() - 1)];
+}
+
+// Sleeps most of the way, then yields for the last couple of milliseconds, which is about as close
+// as a non-realtime thread gets to a sound card's callback timing.
+static void waitUntil(juce::int64 dueTicks) {
+    auto ticksPerMs = juce::Time::getHighResolutionTicksPerSecond() / 1000;
+
+    for (auto remaining = dueTicks - juce::Time::getHighResolutionTicks(); remaining > 0; remaining = dueTicks - juce::Time::getHighResolutionTicks()) {
+        if (remaining > 2 * ticksPerMs) {
+            juce::Thread::sleep(1);
+        }
+        else {
+            juce::Thread::yield();
+        }
+    }
+}
+
+juce::String StressHost::Scenario::getName() const {
+    juce::String name;
+    name << juce::roundToInt(sampleRate) << " Hz, ";
+
+    switch (blockPattern) {
+        case BlockPattern::fixed64: name << "64 sample blocks"; break;
+        case BlockPattern::irregular: name << "irregular blocks"; break;
+        case BlockPattern::oversized: name << "oversized blocks"; break;
+    }
+
+    switch (automation) {
+        case Automation::none: break;
+        case Automation::fftSize: name << ", FFT size automation"; break;
+        case Automation::everything: name << ", automating everything"; break;
+    }
+
+    return name;
+}
+
+bool StressHost::Result::passed() const {
+    return worstUs <= budgetUs && processBlockAllocations == 0 && processBlockLocks == 0;
+}
+
+StressHost::StressHost(const Settings& _settings):
+    settings(_settings)
+{
+}
+
+juce::Array<StressHost::Scenario> StressHost::getAllScenarios() {
+    juce::Array<Scenario> scenarios;
+
+    for (double sampleRate : { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 }) {
+        for (auto blockPattern : { BlockPattern::fixed64, BlockPattern::irregular, BlockPattern::oversized }) {
+            for (auto automation : { Automation::none, Automation::fftSize, Automation::everything }) {
+                Scenario scenario;
+                scenario.sampleRate = sampleRate;
+                scenario.blockPattern = blockPattern;
+                scenario.automation = automation;
+                scenarios.add(scenario);
+            }
+        }
+    }
+
+    return scenarios;
+}
+
+StressHost::Result StressHost::run(const Scenario& scenario) {
+    auto processor = std::make_unique<SpectrogramVSTAudioProcessor>();
+    int maximumBlockSize = getMaximumBlockSize(scenario.blockPattern);
+    int numChannels = juce::jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+
+    processor->setRateAndBufferSizeDetails(scenario.sampleRate, maximumBlockSize);
+    processor->prepareToPlay(scenario.sampleRate, maximumBlockSize);
+
+    juce::AudioBuffer<float> buffer(numChannels, maximumBlockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(0x5eed);
+    auto* fftSizeParameter = processor->apvts.getParameter("FFT Size");
+    auto& parameters = processor->getParameters();
+
+    auto numSamples = (juce::int64)(settings.secondsPerScenario * scenario.sampleRate);
+    auto ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+    auto samplesPerFFTStep = (juce::int64)(0.05 * scenario.sampleRate);
+    int fftSizeIndex = 0;
+    double phase = 0;
+
+    // Allocated up front, so recording the timings doesn't disturb them.
+    std::vector<double> callbackUs;
+    callbackUs.reserve((size_t)(numSamples / 64 + 1024));
+
+    Result result;
+    result.scenario = scenario;
+    result.budgetUs = settings.budgetSamples / scenario.sampleRate * 1.0e6;
+
+    juce::int64 samplePosition = 0;
+    juce::int64 nextFFTStep = 0;
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    while (samplePosition < numSamples) {
+        int blockSize = maximumBlockSize;
+
+        if (scenario.blockPattern == BlockPattern::irregular) {
+            blockSize = random.nextInt(maximumBlockSize + 1);
+        }
+
+        // A 440 Hz tone with a little noise on every channel, so every stream has something to analyse.
+        for (int i = 0; i < blockSize; i++) {
+            float sample = 0.25f * (float)std::sin(phase) + 0.01f * (random.nextFloat() - 0.5f);
+            phase += juce::MathConstants<double>::twoPi * 440.0 / scenario.sampleRate;
+
+            for (int channel = 0; channel < numChannels; channel++) {
+                buffer.setSample(channel, i, sample);
+            }
+        }
+
+        // The host hands over a view of its own buffer, sized to this callback.
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, blockSize);
+
+        juce::AudioProcessorParameter* automatedParameter = nullptr;
+        float automatedValue = 0;
+
+        if (scenario.automation == Automation::fftSize && samplePosition >= nextFFTStep) {
+            fftSizeIndex = (fftSizeIndex + 1) % fftSizeParameter->getNumSteps();
+            automatedParameter = fftSizeParameter;
+            automatedValue = fftSizeParameter->convertTo0to1((float)fftSizeIndex);
+            nextFFTStep += samplesPerFFTStep;
+        }
+        else if (scenario.automation == Automation::everything) {
+            automatedParameter = parameters[random.nextInt(parameters.size())];
+            automatedValue = random.nextFloat();
+        }
+
+        if (settings.realTime) {
+            waitUntil(startTicks + (juce::int64)((double)samplePosition / scenario.sampleRate * ticksPerSecond));
+        }
+
+        auto allocationsBefore = AllocationGuard::getNumAllocationsOnThisThread();
+        auto locksBefore = LockCounter::getNumLocksOnThisThread();
+        auto callbackStart = juce::Time::getHighResolutionTicks();
+
+        // The same two calls JUCE's plugin wrappers make for incoming host automation.
+        if (automatedParameter != nullptr) {
+            automatedParameter->setValue(automatedValue);
+            automatedParameter->sendValueChangedMessageToListeners(automatedValue);
+        }
+
+        auto allocationsAfterAutomation = AllocationGuard::getNumAllocationsOnThisThread();
+        auto locksAfterAutomation = LockCounter::getNumLocksOnThisThread();
+
+        processor->processBlock(block, midi);
+
+        auto callbackEnd = juce::Time::getHighResolutionTicks();
+
+        result.automationAllocations += allocationsAfterAutomation - allocationsBefore;
+        result.automationLocks += locksAfterAutomation - locksBefore;
+        result.processBlockAllocations += AllocationGuard::getNumAllocationsOnThisThread() - allocationsAfterAutomation;
+        result.processBlockLocks += LockCounter::getNumLocksOnThisThread() - locksAfterAutomation;
+
+        double us = (double)(callbackEnd - callbackStart) / ticksPerSecond * 1.0e6;
+        callbackUs.push_back(us);
+        result.numBlocksOverBudget += us > result.budgetUs ? 1 : 0;
+
+        samplePosition += blockSize;
+    }
+
+    processor->releaseResources();
+
+    std::sort(callbackUs.begin(), callbackUs.end());
+    result.numBlocks = (juce::int64)callbackUs.size();
+    result.medianUs = getPercentile(callbackUs, 0.5);
+    result.p99Us = getPercentile(callbackUs, 0.99);
+    result.p999Us = getPercentile(callbackUs, 0.999);
+    result.worstUs = callbackUs.back();
+
+    return result;
+}
+
+juce::var StressHost::toJSON(const juce::Array<Result>& results) const {
+    juce::Array<juce::var> entries;
+
+    for (auto& result : results) {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("scenario", result.scenario.getName());
+        entry->setProperty("sampleRate", result.scenario.sampleRate);
+        entry->setProperty("numBlocks", result.numBlocks);
+        entry->setProperty("medianUs", result.medianUs);
+        entry->setProperty("p99Us", result.p99Us);
+        entry->setProperty("p999Us", result.p999Us);
+        entry->setProperty("worstUs", result.worstUs);
+        entry->setProperty("budgetUs", result.budgetUs);
+        entry->setProperty("numBlocksOverBudget", result.numBlocksOverBudget);
+        entry->setProperty("processBlockAllocations", result.processBlockAllocations);
+        entry->setProperty("processBlockLocks", LockCounter::isAvailable() ? juce::var(result.processBlockLocks) : juce::var());
+        entry->setProperty("automationAllocations", result.automationAllocations);
+        entry->setProperty("automationLocks", LockCounter::isAvailable() ? juce::var(result.automationLocks) : juce::var());
+        entry->setProperty("passed", result.passed());
+        entries.add(juce::var(entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("budgetSamples", settings.budgetSamples);
+    root->setProperty("secondsPerScenario", settings.secondsPerScenario);
+    root->setProperty("realTime", settings.realTime);
+    root->setProperty("countsAllocations", AllocationGuard::isEnabled());
+    root->setProperty("countsLocks", LockCounter::isAvailable());
+    root->setProperty("operatingSystem", juce::SystemStats::getOperatingSystemName());
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("results", entries);
+
+    return juce::var(root);
+}
+
+int StressHost::getMaximumBlockSize(BlockPattern blockPattern) {
+    switch (blockPattern) {
+        case BlockPattern::fixed64: return 64;
+        case BlockPattern::irregular: return 2048;
+        case BlockPattern::oversized: return 16384;
+    }
+
+    return 64;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+// Plays the part of a host: creates the processor, prepares it, and calls processBlock from one thread
+// the way a host's audio callback would, with whatever block sizes and automation a scenario asks for.
+// Every callback is timed, and the allocations and locks it made are counted.
+class StressHost
+{
+public:
+    enum class BlockPattern
+    {
+        fixed64,    // the budget itself
+        irregular,  // anything from 0 to 2048 samples, as hosts do around loops and automation
+        oversized   // 16384 samples, twice the largest FFT
+    };
+
+    enum class Automation
+    {
+        none,
+        fftSize,    // steps through every FFT size
+        everything  // a random parameter to a random value, every callback
+    };
+
+    struct Scenario
+    {
+        double sampleRate = 48000;
+        BlockPattern blockPattern = BlockPattern::fixed64;
+        Automation automation = Automation::none;
+
+        juce::String getName() const;
+    };
+
+    struct Settings
+    {
+        double secondsPerScenario = 2;
+        int budgetSamples = 64;
+
+        // Waits out each block's duration like a real audio callback, rather than calling back to back.
+        bool realTime = true;
+    };
+
+    struct Result
+    {
+        Scenario scenario;
+        juce::int64 numBlocks = 0;
+
+        // Microseconds per callback (automation plus processBlock).
+        double medianUs = 0;
+        double p99Us = 0;
+        double p999Us = 0;
+        double worstUs = 0;
+        double budgetUs = 0;
+        juce::int64 numBlocksOverBudget = 0;
+
+        // What processBlock itself did, and what delivering the automation did before it.
+        juce::int64 processBlockAllocations = 0;
+        juce::int64 processBlockLocks = 0;
+        juce::int64 automationAllocations = 0;
+        juce::int64 automationLocks = 0;
+
+        // Within budget, and processBlock neither allocated nor locked.
+        bool passed() const;
+    };
+
+    StressHost(const Settings& _settings);
+
+    static juce::Array<Scenario> getAllScenarios();
+
+    Result run(const Scenario& scenario);
+
+    juce::var toJSON(const juce::Array<Result>& results) const;
+
+private:
+    Settings settings;
+
+    static int getMaximumBlockSize(BlockPattern blockPattern);
+
+    JUCE_DECLARE_NON_COPYABLE(StressHost)
+};